@@ -12,13 +12,20 @@
 #include <QApplication>
 #include <QSignalSpy>
 #include <QRandomGenerator>
+#include <QRegion>
+#include <QSet>
 #include <QProcess>
+
+#include <array>
+#include <tuple>
 Plasma::Applet *SimpleLoader::internalLoadApplet(const QString &name, uint appletId,
                                    const QVariantList &args)
 {
     Q_UNUSED(args)
     if (name == QLatin1String("simpleapplet")) {
         return new SimpleApplet(nullptr, QString(), appletId);
+    } else if (name == QLatin1String("requeueingapplet")) {
+        return new RequeueingApplet(nullptr, QString(), appletId);
     } else if (name == QLatin1String("simplecontainment")) {
         return new SimpleContainment(nullptr, QString(), appletId);
     } else if (name == QLatin1String("simplenoscreencontainment")) {
@@ -52,6 +59,31 @@ int SimpleCorona::screenForContainment(const Plasma::Containment *c) const
     return 0;
 }
 
+DeferringCorona::DeferringCorona(QObject *parent)
+    : SimpleCorona(parent)
+{
+}
+
+QRect DeferringCorona::screenGeometry(int screen) const
+{
+    if (screen >= m_screens) {
+        return QRect();
+    }
+    return SimpleCorona::screenGeometry(screen);
+}
+
+void DeferringCorona::addScreen()
+{
+    ++m_screens;
+    Q_EMIT screenAdded(m_screens - 1);
+}
+
+void DeferringCorona::removeScreen()
+{
+    --m_screens;
+    Q_EMIT screenRemoved(m_screens);
+}
+
 SimpleApplet::SimpleApplet(QObject *parent , const QString &serviceId, uint appletId)
     : Plasma::Applet(parent, serviceId, appletId)
 {
@@ -65,6 +97,20 @@ SimpleApplet::SimpleApplet(QObject *parent , const QString &serviceId, uint appl
 }
 
 
+RequeueingApplet::RequeueingApplet(QObject *parent, const QString &serviceId, uint appletId)
+    : Plasma::Applet(parent, serviceId, appletId)
+{
+}
+
+void RequeueingApplet::constraintsEvent(Plasma::Types::Constraints constraints)
+{
+    Q_UNUSED(constraints)
+    ++constraintsEvents;
+    if (requeueing) {
+        updateConstraints(Plasma::Types::FormFactorConstraint);
+    }
+}
+
 SimpleContainment::SimpleContainment(QObject *parent , const QString &serviceId, uint appletId)
     : Plasma::Containment(parent, serviceId, appletId)
 {
@@ -187,6 +233,144 @@ void CoronaTest::addRemoveApplets()
     QCOMPARE(m_corona->containments().at(0)->applets().count(), 2);
 }
 
+void CoronaTest::constraintsBatching()
+{
+    // let anything still pending go first
+    QTest::qWait(0);
+    const quint64 flushes = m_corona->constraintsFlushCount();
+    const quint64 events = m_corona->constraintsEventCount();
+
+    Plasma::Containment *desktop = m_corona->containments().at(0);
+    Plasma::Containment *panel = m_corona->containments().at(1);
+    QCOMPARE(desktop->applets().count(), 2);
+    QSignalSpy appletSpy(desktop->applets().at(0), &Plasma::Applet::formFactorChanged);
+
+    desktop->setFormFactor(Plasma::Types::Vertical);
+    panel->setFormFactor(Plasma::Types::Vertical);
+
+    // the containments, then the applets they passed the form factor on to, all at once
+    QVERIFY(appletSpy.wait(1000));
+    QCOMPARE(m_corona->constraintsFlushCount(), flushes + 1);
+    QCOMPARE(m_corona->constraintsEventCount(), events + 4);
+    QCOMPARE(desktop->applets().at(0)->formFactor(), Plasma::Types::Vertical);
+}
+
+void CoronaTest::constraintsRequeueing()
+{
+    Plasma::Containment *desktop = m_corona->containments().at(0);
+    RequeueingApplet *applet = qobject_cast<RequeueingApplet *>(desktop->createApplet(QStringLiteral("requeueingapplet")));
+    QVERIFY(applet);
+    QTest::qWait(0);
+
+    const quint64 flushes = m_corona->constraintsFlushCount();
+    const int events = applet->constraintsEvents;
+    applet->requeueing = true;
+    applet->updateConstraints(Plasma::Types::FormFactorConstraint);
+
+    // each flush queues it again, for the next pass rather than the same one
+    QTRY_VERIFY(m_corona->constraintsFlushCount() >= flushes + 3);
+    QCOMPARE(quint64(applet->constraintsEvents - events), m_corona->constraintsFlushCount() - flushes);
+
+    delete applet;
+    QTest::qWait(0);
+}
+
+void CoronaTest::deferredLoading()
+{
+    {
+        KConfig layout(m_configDir.filePath(QStringLiteral("plasma-deferred-appletsrc")), KConfig::SimpleConfig);
+        // id, activity, screen, applet id: the applets of the deferred
+        // containments come right after the ids used by the others
+        const std::array<std::tuple<int, const char *, int, int>, 5> containments = {{
+            {10, "running", 0, 20},
+            {11, "stopped", 0, 21},
+            {12, "", 1, 22},
+            {13, "other", 0, 23},
+            {14, "", -1, 19},
+        }};
+        for (const auto &containment : containments) {
+            KConfigGroup cg(&layout, "Containments");
+            cg = KConfigGroup(&cg, QString::number(std::get<0>(containment)));
+            cg.writeEntry("plugin", "simplecontainment");
+            cg.writeEntry("activityId", QString::fromLatin1(std::get<1>(containment)));
+            cg.writeEntry("lastScreen", std::get<2>(containment));
+            KConfigGroup applet(&cg, "Applets");
+            applet = KConfigGroup(&applet, QString::number(std::get<3>(containment)));
+            applet.writeEntry("plugin", "simpleapplet");
+        }
+    }
+
+    DeferringCorona corona;
+    corona.setDeferredLoadingEnabled(true);
+    corona.setRunningActivities({QStringLiteral("running")});
+    corona.loadLayout(QStringLiteral("plasma-deferred-appletsrc"));
+
+    // the running activity, and the containment of no screen
+    QCOMPARE(corona.containments().count(), 2);
+    QCOMPARE(corona.deferredContainmentsCount(), 3);
+    QCOMPARE(corona.containments().at(0)->id(), 10u);
+    QCOMPARE(corona.containments().at(0)->applets().count(), 1);
+
+    // saving elsewhere keeps them all
+    corona.saveLayout(QStringLiteral("plasma-deferred-copy-appletsrc"));
+    KConfig copy(m_configDir.filePath(QStringLiteral("plasma-deferred-copy-appletsrc")), KConfig::SimpleConfig);
+    QCOMPARE(copy.group("Containments").groupList().count(), 5);
+
+    // an applet added meanwhile can't take the id of one not loaded yet
+    QVERIFY(corona.containments().at(0)->createApplet(QStringLiteral("simpleapplet")));
+
+    // an activity being started
+    QSignalSpy addedSpy(&corona, &Plasma::Corona::containmentAdded);
+    corona.setRunningActivities({QStringLiteral("running"), QStringLiteral("stopped")});
+    QCOMPARE(addedSpy.count(), 1);
+    QCOMPARE(corona.deferredContainmentsCount(), 2);
+    Plasma::Containment *started = qvariant_cast<Plasma::Containment *>(addedSpy.first().first());
+    QCOMPARE(started->id(), 11u);
+    QCOMPARE(started->activity(), QStringLiteral("stopped"));
+    QCOMPARE(started->applets().count(), 1);
+    QCOMPARE(started->applets().first()->id(), 21u);
+
+    // a screen being connected
+    corona.addScreen();
+    QCOMPARE(corona.deferredContainmentsCount(), 1);
+    QCOMPARE(corona.containmentsForScreen(1).count(), 1);
+
+    // looking up an activity loads its containments
+    const auto other = corona.containmentsForActivity(QStringLiteral("other"));
+    QCOMPARE(other.count(), 1);
+    QCOMPARE(other.first()->id(), 13u);
+    QCOMPARE(corona.deferredContainmentsCount(), 0);
+    QCOMPARE(corona.containments().count(), 5);
+
+    QSet<uint> ids;
+    int applets = 0;
+    for (Plasma::Containment *containment : corona.containments()) {
+        ids.insert(containment->id());
+        for (Plasma::Applet *applet : containment->applets()) {
+            ids.insert(applet->id());
+            ++applets;
+        }
+    }
+    QCOMPARE(applets, 6);
+    QCOMPARE(ids.count(), 5 + applets);
+}
+
+void CoronaTest::availableRegionScreens()
+{
+    DeferringCorona corona;
+    QVERIFY(corona.cachedAvailableScreenRegion(1).isEmpty());
+    QVERIFY(!corona.availableScreenRegionContains(1, QRect(110, 110, 10, 10)));
+
+    // no region change is emitted, the screen itself drops the cache
+    corona.addScreen();
+    QCOMPARE(corona.cachedAvailableScreenRegion(1), QRegion(corona.screenGeometry(1)));
+    QVERIFY(corona.availableScreenRegionContains(1, QRect(110, 110, 10, 10)));
+
+    corona.removeScreen();
+    QVERIFY(corona.cachedAvailableScreenRegion(1).isEmpty());
+    QVERIFY(!corona.availableScreenRegionContains(1, QRect(110, 110, 10, 10)));
+}
+
 //this test has to be the last, since systemimmutability
 //can't be programmatically unlocked
 void CoronaTest::immutability()
@@ -33,6 +33,22 @@ public:
     int screenForContainment(const Plasma::Containment *) const override;
 };
 
+// a corona with some screens connected, and more to come
+class DeferringCorona : public SimpleCorona
+{
+    Q_OBJECT
+
+public:
+    explicit DeferringCorona(QObject *parent = nullptr);
+
+    QRect screenGeometry(int screen) const override;
+    void addScreen();
+    void removeScreen();
+
+private:
+    int m_screens = 1;
+};
+
 class SimpleApplet : public Plasma::Applet
 {
     Q_OBJECT
@@ -43,6 +59,21 @@ private:
     QTimer m_timer;
 };
 
+// an applet queueing its constraints again each time they're flushed
+class RequeueingApplet : public Plasma::Applet
+{
+    Q_OBJECT
+
+public:
+    explicit RequeueingApplet(QObject *parent = nullptr, const QString &serviceId = QString(), uint appletId = 0);
+
+    bool requeueing = false;
+    int constraintsEvents = 0;
+
+protected:
+    void constraintsEvent(Plasma::Types::Constraints constraints) override;
+};
+
 class SimpleContainment : public Plasma::Containment
 {
     Q_OBJECT
@@ -74,6 +105,10 @@ private Q_SLOTS:
     void checkOrder();
     void startupCompletion();
     void addRemoveApplets();
+    void constraintsBatching();
+    void constraintsRequeueing();
+    void deferredLoading();
+    void availableRegionScreens();
     void immutability();
 
 private:
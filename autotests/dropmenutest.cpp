@@ -0,0 +1,47 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "dropmenutest.h"
+
+#include <QApplication>
+#include <QMenu>
+#include <QPointer>
+
+#include <KIO/MimetypeJob>
+
+#include "dropmenu.h"
+
+void DropMenuTest::dismissWhilePending()
+{
+    const QUrl url = QUrl::fromLocalFile(QFINDTESTDATA("data/test_image.png"));
+    QPointer<DropMenu> dropMenu = new DropMenu(nullptr, QPoint(10, 10));
+    dropMenu->setUrls({url});
+    dropMenu->showPending();
+    QMenu *menu = qobject_cast<QMenu *>(QApplication::activePopupWidget());
+    QVERIFY(menu);
+
+    // where ContainmentInterface gets the type from
+    int delivered = 0;
+    QObject receiver;
+    QPointer<KIO::MimetypeJob> job = KIO::mimetype(url, KIO::HideProgressInfo);
+    connect(job.data(), &KIO::MimetypeJob::mimeTypeFound, &receiver, [&delivered]() {
+        ++delivered;
+    });
+    connect(job.data(), &KJob::result, &receiver, [&delivered]() {
+        ++delivered;
+    });
+    dropMenu->setMimeTypeJob(job);
+
+    // dismissed before the type is known: the job goes away with the menu
+    // and the type never gets delivered
+    menu->hide();
+    QTRY_VERIFY(!dropMenu);
+    QVERIFY(!job);
+    QTest::qWait(100);
+    QCOMPARE(delivered, 0);
+}
+
+QTEST_MAIN(DropMenuTest)
@@ -0,0 +1,19 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef DROPMENUTEST_H
+#define DROPMENUTEST_H
+
+#include <QTest>
+
+class DropMenuTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void dismissWhilePending();
+};
+
+#endif
@@ -5,6 +5,7 @@
 */
 
 #include "framesvgtest.h"
+#include <QSignalSpy>
 #include <QStandardPaths>
 
 
@@ -58,6 +59,28 @@ void FrameSvgTest::repaintBlocked()
     QCOMPARE(m_frameSvg->frameSize(), QSizeF(100,100));
 }
 
+void FrameSvgTest::sharedGeometry()
+{
+    // a second frame of the same image reuses the measured geometry,
+    // switching borders back and forth must still give the right margins
+    Plasma::FrameSvg frameSvg;
+    frameSvg.setImagePath(QFINDTESTDATA("data/background.svgz"));
+    QVERIFY(frameSvg.isValid());
+
+    QSignalSpy sizeSpy(&frameSvg, &Plasma::Svg::sizeChanged);
+
+    frameSvg.setEnabledBorders(Plasma::FrameSvg::NoBorder);
+    QCOMPARE(frameSvg.marginSize(Plasma::Types::LeftMargin), (qreal)0);
+    QCOMPARE(frameSvg.fixedMarginSize(Plasma::Types::LeftMargin), (qreal)26);
+
+    frameSvg.setEnabledBorders(Plasma::FrameSvg::AllBorders);
+    QCOMPARE(frameSvg.marginSize(Plasma::Types::LeftMargin), (qreal)26);
+    QCOMPARE(frameSvg.marginSize(Plasma::Types::BottomMargin), (qreal)26);
+
+    // the geometry was already known, so the svg never had to be resized to measure it
+    QCOMPARE(sizeSpy.count(), 0);
+}
+
 void FrameSvgTest::setTheme()
 {
     // Should not crash
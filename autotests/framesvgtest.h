@@ -26,6 +26,7 @@ private Q_SLOTS:
     void contentsRect();
     void setTheme();
     void repaintBlocked();
+    void sharedGeometry();
 
 private:
     Plasma::FrameSvg *m_frameSvg;
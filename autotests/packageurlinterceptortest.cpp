@@ -0,0 +1,43 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "packageurlinterceptortest.h"
+
+#include <QDir>
+#include <QQmlEngine>
+
+#include <KPackage/Package>
+
+#include "plasmaquick/packageurlinterceptor.h"
+
+void PackageUrlInterceptorTest::cachedResolution()
+{
+    QQmlEngine engine;
+    PlasmaQuick::PackageUrlInterceptor interceptor(&engine, KPackage::Package());
+
+    // an image under ui/ is looked for under images/ first
+    const QUrl image = QUrl::fromLocalFile(QDir::tempPath() + QStringLiteral("/package/contents/ui/image.png"));
+    const QUrl first = interceptor.intercept(image, QQmlAbstractUrlInterceptor::UrlString);
+    QCOMPARE(interceptor.statistics().filesystemProbes, quint64(1));
+
+    // the second time it comes from the cache, without touching the disk
+    QCOMPARE(interceptor.intercept(image, QQmlAbstractUrlInterceptor::UrlString), first);
+    QCOMPARE(interceptor.statistics().intercepts, quint64(2));
+    QCOMPARE(interceptor.statistics().cacheHits, quint64(1));
+    QCOMPARE(interceptor.statistics().filesystemProbes, quint64(1));
+
+    // the same url as another type is resolved on its own
+    interceptor.intercept(image, QQmlAbstractUrlInterceptor::JavaScriptFile);
+    QCOMPARE(interceptor.statistics().cacheHits, quint64(1));
+    QCOMPARE(interceptor.statistics().filesystemProbes, quint64(2));
+
+    // qmldir files are never intercepted
+    const QUrl qmldir = QUrl::fromLocalFile(QDir::tempPath() + QStringLiteral("/package/contents/ui/qmldir"));
+    QCOMPARE(interceptor.intercept(qmldir, QQmlAbstractUrlInterceptor::QmldirFile), qmldir);
+    QCOMPARE(interceptor.statistics().intercepts, quint64(3));
+}
+
+QTEST_MAIN(PackageUrlInterceptorTest)
@@ -8,7 +8,13 @@
 
 #include <qtest.h>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QSignalSpy>
+#include <QStandardPaths>
 
 #include <KPluginInfo>
 #include <KPluginMetaData>
@@ -23,6 +29,12 @@ PluginTest::PluginTest()
 {
 }
 
+void PluginTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma/plasmoids")).removeRecursively();
+}
+
 void PluginTest::listEngines()
 {
     QVector<KPluginMetaData> plugins = Plasma::PluginLoader::self()->listDataEngineMetaData();
@@ -91,5 +103,75 @@ void PluginTest::loadDataEngine()
     QVERIFY(!nullEngine.isNull() && engine.isNull());
 }
 
-#include "moc_pluginloadertest.cpp"
+static void installDropApplet(const QString &id, const QStringList &mimeTypes, const QStringList &urlPatterns)
+{
+    const QString path = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma/plasmoids/") + id;
+    QVERIFY(QDir().mkpath(path + QStringLiteral("/contents/ui")));
+
+    QJsonObject metadata {
+        {QStringLiteral("KPackageStructure"), QStringLiteral("Plasma/Applet")},
+        {QStringLiteral("KPlugin"), QJsonObject {
+            {QStringLiteral("Id"), id},
+            {QStringLiteral("Name"), id},
+            {QStringLiteral("ServiceTypes"), QJsonArray {QStringLiteral("Plasma/Applet")}},
+        }},
+        {QStringLiteral("X-KDE-ParentApp"), QCoreApplication::applicationName()},
+        {QStringLiteral("X-Plasma-API"), QStringLiteral("declarativeappletscript")},
+        {QStringLiteral("X-Plasma-MainScript"), QStringLiteral("ui/main.qml")},
+    };
+    if (!mimeTypes.isEmpty()) {
+        metadata.insert(QStringLiteral("X-Plasma-DropMimeTypes"), QJsonArray::fromStringList(mimeTypes));
+    }
+    if (!urlPatterns.isEmpty()) {
+        metadata.insert(QStringLiteral("X-Plasma-DropUrlPatterns"), QJsonArray::fromStringList(urlPatterns));
+    }
 
+    QFile file(path + QStringLiteral("/metadata.json"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(QJsonDocument(metadata).toJson());
+}
+
+static QSet<QString> pluginIds(const QList<KPluginMetaData> &plugins)
+{
+    QSet<QString> ids;
+    for (const KPluginMetaData &plugin : plugins) {
+        ids << plugin.pluginId();
+    }
+    return ids;
+}
+
+void PluginTest::dropQueries()
+{
+    installDropApplet(QStringLiteral("org.kde.test.droptext"), {QStringLiteral("text/plain")}, {});
+    installDropApplet(QStringLiteral("org.kde.test.dropimage"), {QStringLiteral("image/png")}, {QStringLiteral("https://example.org/*")});
+    installDropApplet(QStringLiteral("org.kde.test.dropfile"), {}, {QStringLiteral("*.png")});
+
+    Plasma::PluginLoader *loader = Plasma::PluginLoader::self();
+    const QSet<QString> textApplets = pluginIds(loader->listAppletMetaDataForMimeType(QStringLiteral("text/plain")));
+    if (!textApplets.contains(QStringLiteral("org.kde.test.droptext"))) {
+        QSKIP("The applet package structure is not installed");
+    }
+
+    // exact and inherited mime types
+    QCOMPARE(textApplets, QSet<QString>({QStringLiteral("org.kde.test.droptext")}));
+    QVERIFY(pluginIds(loader->listAppletMetaDataForMimeType(QStringLiteral("text/x-csrc"))).contains(QStringLiteral("org.kde.test.droptext")));
+    QCOMPARE(pluginIds(loader->listAppletMetaDataForMimeType(QStringLiteral("image/png"))), QSet<QString>({QStringLiteral("org.kde.test.dropimage")}));
+    QVERIFY(loader->listAppletMetaDataForMimeType(QStringLiteral("application/x-test-nothing")).isEmpty());
+
+    // url patterns, with and without a literal scheme
+    QCOMPARE(pluginIds(loader->listAppletMetaDataForUrl(QUrl(QStringLiteral("https://example.org/a.png")))),
+             QSet<QString>({QStringLiteral("org.kde.test.dropimage"), QStringLiteral("org.kde.test.dropfile")}));
+    QCOMPARE(pluginIds(loader->listAppletMetaDataForUrl(QUrl(QStringLiteral("file:///tmp/a.png")))),
+             QSet<QString>({QStringLiteral("org.kde.test.dropfile")}));
+    QVERIFY(loader->listAppletMetaDataForUrl(QUrl(QStringLiteral("https://example.com/a.txt"))).isEmpty());
+
+    // a newly installed package is picked up
+    installDropApplet(QStringLiteral("org.kde.test.dropmore"), {QStringLiteral("image/png")}, {});
+    QTRY_VERIFY(pluginIds(loader->listAppletMetaDataForMimeType(QStringLiteral("image/png"))).contains(QStringLiteral("org.kde.test.dropmore")));
+
+    // and so is the metadata of an installed package being rewritten in place
+    installDropApplet(QStringLiteral("org.kde.test.droptext"), {QStringLiteral("text/plain"), QStringLiteral("image/png")}, {});
+    QTRY_VERIFY(pluginIds(loader->listAppletMetaDataForMimeType(QStringLiteral("image/png"))).contains(QStringLiteral("org.kde.test.droptext")));
+}
+
+#include "moc_pluginloadertest.cpp"
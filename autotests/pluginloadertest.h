@@ -17,12 +17,14 @@ public:
     PluginTest();
 
 private Q_SLOTS:
+    void initTestCase();
     void listEngines();
     void listAppletCategories();
     void listContainmentActions();
     void listContainmentsOfType();
 
     void loadDataEngine();
+    void dropQueries();
 
 private:
     bool m_buildonly;
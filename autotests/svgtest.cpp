@@ -0,0 +1,57 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "svgtest.h"
+
+#include <QPixmap>
+#include <QStandardPaths>
+
+void SvgTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    m_cacheDir = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    m_cacheDir.removeRecursively();
+}
+
+void SvgTest::cleanupTestCase()
+{
+    m_cacheDir.removeRecursively();
+}
+
+void SvgTest::sharedImages()
+{
+    // the same rendering is handed out as the same image, so whatever
+    // is derived from it, like scene graph textures, can be shared too
+    Plasma::Svg svg;
+    svg.setImagePath(QFINDTESTDATA("data/background.svgz"));
+    svg.setContainsMultipleImages(true);
+
+    const QImage first = svg.image(QSize(32, 32), QStringLiteral("topleft"));
+    const QImage second = svg.image(QSize(32, 32), QStringLiteral("topleft"));
+    QVERIFY(!first.isNull());
+    QCOMPARE(first.size(), QSize(32, 32));
+    QCOMPARE(first.cacheKey(), second.cacheKey());
+
+    const QImage other = svg.image(QSize(16, 16), QStringLiteral("topleft"));
+    QVERIFY(other.cacheKey() != first.cacheKey());
+}
+
+void SvgTest::sharedPixmaps()
+{
+    // pixmaps found in the cache aren't converted from the image again
+    Plasma::Svg svg;
+    svg.setImagePath(QFINDTESTDATA("data/background.svgz"));
+    svg.setContainsMultipleImages(true);
+    svg.resize(32, 32);
+
+    const QPixmap first = svg.pixmap(QStringLiteral("topleft"));
+    const QPixmap second = svg.pixmap(QStringLiteral("topleft"));
+    QVERIFY(!first.isNull());
+    QCOMPARE(first.size(), QSize(32, 32));
+    QCOMPARE(first.cacheKey(), second.cacheKey());
+}
+
+QTEST_MAIN(SvgTest)
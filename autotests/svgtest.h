@@ -0,0 +1,30 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef SVGTEST_H
+#define SVGTEST_H
+
+#include <QDir>
+#include <QTest>
+
+#include "plasma/svg.h"
+
+class SvgTest : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+private Q_SLOTS:
+    void sharedImages();
+    void sharedPixmaps();
+
+private:
+    QDir m_cacheDir;
+};
+
+#endif
@@ -9,6 +9,7 @@
 #include <QStandardPaths>
 #include <QApplication>
 #include <QSignalSpy>
+#include <QTemporaryDir>
 
 #include <KIconLoader>
 #include <KIconTheme>
@@ -19,8 +20,25 @@
 #include <KSelectionOwner>
 #endif
 #include <array>
-
-QString cacheIdHash(const Plasma::SvgPrivate::CacheId &id)
+#include <memory>
+#include <vector>
+
+// Mirrors Plasma::SvgPrivate::CacheId, with the strings its interned ids stand for:
+// the hash is persisted in the pixmap cache, so it must not depend from the interning
+struct CacheIdentifier {
+    double width;
+    double height;
+    QString filePath;
+    QString elementName;
+    int status;
+    double devicePixelRatio;
+    double scaleFactor;
+    int colorGroup;
+    uint extraFlags;
+    uint lastModified;
+};
+
+QString cacheIdHash(const CacheIdentifier &id)
 {
     static const uint seed = 0x9e3779b9;
     std::array<uint, 10> parts = {
@@ -92,7 +110,7 @@ void ThemeTest::loadSvgIcon()
 
     QFileInfo info(iconPath);
 
-    QString cacheId = cacheIdHash(Plasma::SvgPrivate::CacheId{48, 48, iconPath, QString(), m_svg->status(), m_svg->devicePixelRatio(), m_svg->scaleFactor(), m_svg->colorGroup(), 0, static_cast<uint>(info.lastModified().toSecsSinceEpoch())});
+    QString cacheId = cacheIdHash(CacheIdentifier{48, 48, iconPath, QString(), m_svg->status(), m_svg->devicePixelRatio(), m_svg->scaleFactor(), m_svg->colorGroup(), 0, static_cast<uint>(info.lastModified().toSecsSinceEpoch())});
 
     QPixmap result;
     QVERIFY(m_svg->theme()->findInCache(cacheId, result, info.lastModified().toSecsSinceEpoch()));
@@ -208,6 +226,44 @@ void ThemeTest::testColors()
                             Plasma::Theme::ComplementaryColorGroup), QColor(237,21,24));
 }
 
+void ThemeTest::testPaletteChangeBatching()
+{
+    const QColor textColor = m_theme->color(Plasma::Theme::TextColor);
+
+    // an unthemed svg asking for the color scheme repaints every time the colors get rebuilt
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QFile file(dir.filePath(QStringLiteral("colors.svg")));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"16\" height=\"16\">"
+               "<rect id=\"hint-apply-color-scheme\" width=\"16\" height=\"16\"/></svg>");
+    file.close();
+    Plasma::Svg svg;
+    svg.setTheme(m_theme);
+    svg.setImagePath(file.fileName());
+    QVERIFY(svg.isValid());
+
+    QSignalSpy themeChangedSpy(m_theme, &Plasma::Theme::themeChanged);
+    QVERIFY(themeChangedSpy.isValid());
+    QSignalSpy repaintSpy(&svg, &Plasma::Svg::repaintNeeded);
+    QVERIFY(repaintSpy.isValid());
+
+    // a burst of palette changes must rebuild the colors once, and result in a single notification
+    for (int i = 0; i < 10; ++i) {
+        QEvent event(QEvent::ApplicationPaletteChange);
+        QCoreApplication::sendEvent(QCoreApplication::instance(), &event);
+    }
+
+    QVERIFY(themeChangedSpy.wait());
+    QVERIFY(!themeChangedSpy.wait(200));
+    QCOMPARE(themeChangedSpy.count(), 1);
+    // one repaint for the new colors, one for the theme change
+    QCOMPARE(repaintSpy.count(), 2);
+
+    // the theme brings its own colors, they don't depend from the palette
+    QCOMPARE(m_theme->color(Plasma::Theme::TextColor), textColor);
+}
+
 void ThemeTest::testCompositingChange()
 {
     // this test simulates the compositing change on X11
@@ -249,5 +305,238 @@ void ThemeTest::testCompositingChange()
 #endif
 }
 
+void ThemeTest::testImagePathManifest()
+{
+    const QString name = QStringLiteral("widgets/manifesttest");
+    // misses are remembered, until the theme changes on disk
+    QVERIFY(m_theme->imagePath(name).isEmpty());
+    QVERIFY(!m_theme->currentThemeHasImage(name));
+
+    const QString themeDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma/desktoptheme/testtheme");
+    QVERIFY(QDir().mkpath(themeDir + QStringLiteral("/widgets")));
+    // a link back to the theme, listing the theme must not loop through it
+    QVERIFY(QFile::link(themeDir, themeDir + QStringLiteral("/widgets/loop")));
+    QVERIFY(QFile::copy(QFINDTESTDATA("data/plasma/desktoptheme/testtheme/element.svg"), themeDir + QStringLiteral("/widgets/manifesttest.svg")));
+    // the files of a theme are only looked at again when its metadata changes
+    const QString metadataFile = themeDir + QStringLiteral("/metadata.desktop");
+    QVERIFY(QFile::copy(QFINDTESTDATA("data/plasma/desktoptheme/testtheme/metadata.desktop"), metadataFile));
+
+    QTRY_VERIFY(m_theme->imagePath(name).endsWith(QLatin1String("/widgets/manifesttest.svg")));
+    QVERIFY(m_theme->currentThemeHasImage(name));
+    // the rest of the theme is still found where it was
+    QVERIFY(m_theme->imagePath(QStringLiteral("element")).contains(QLatin1String("/desktoptheme/testtheme/")));
+
+    QVERIFY(QFile::remove(themeDir + QStringLiteral("/widgets/manifesttest.svg")));
+    QVERIFY(QFile::remove(metadataFile));
+    QTRY_VERIFY(m_theme->imagePath(name).isEmpty());
+
+    QDir(themeDir).removeRecursively();
+}
+
+void ThemeTest::testWallpaperBestFit()
+{
+    const QString imagesDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/wallpapers/default/contents/images/");
+    QVERIFY(QDir().mkpath(imagesDir));
+    // only the file names matter
+    for (const char *name : {"640x480.png", "1024x768.png", "1920x1080.png", "2560x1440.png", "notasize.png", "800x600.jpg"}) {
+        QFile file(imagesDir + QLatin1String(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+
+    QCOMPARE(m_theme->wallpaperPath(QSize(1024, 768)), imagesDir + QStringLiteral("1024x768.png"));
+    // closest to the default size, 1920x1200
+    QCOMPARE(m_theme->wallpaperPath(), imagesDir + QStringLiteral("1920x1080.png"));
+    // bigger is better than blurry, a different aspect ratio is worse than both
+    QCOMPARE(m_theme->wallpaperPath(QSize(800, 600)), imagesDir + QStringLiteral("1024x768.png"));
+    QCOMPARE(m_theme->wallpaperPath(QSize(1280, 720)), imagesDir + QStringLiteral("1920x1080.png"));
+    QCOMPARE(m_theme->wallpaperPath(QSize(3840, 2160)), imagesDir + QStringLiteral("2560x1440.png"));
+
+    // sizes being installed later
+    QFile file(imagesDir + QStringLiteral("1280x720.png"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+    QTRY_COMPARE(m_theme->wallpaperPath(QSize(1280, 720)), imagesDir + QStringLiteral("1280x720.png"));
+
+    QDir(imagesDir).removeRecursively();
+}
+
+void ThemeTest::testImageCacheStatistics()
+{
+    Plasma::Svg svg;
+    svg.setTheme(m_theme);
+    svg.setImagePath(QStringLiteral("element"));
+    QVERIFY(svg.isValid());
+    const QString path = m_theme->imagePath(QStringLiteral("element"));
+
+    auto consumer = [this, &path]() {
+        return m_theme->cacheStatistics().value(QStringLiteral("consumers")).toMap().value(path).toMap();
+    };
+    auto memory = [this]() {
+        return m_theme->cacheStatistics().value(QStringLiteral("memory")).toMap();
+    };
+
+    const QImage first = svg.image(QSize(32, 32));
+    QVERIFY(!first.isNull());
+    QCOMPARE(consumer().value(QStringLiteral("images")).toInt(), 1);
+    QCOMPARE(consumer().value(QStringLiteral("bytes")).toLongLong(), first.sizeInBytes());
+    QCOMPARE(consumer().value(QStringLiteral("elements")).toMap().value(QString()).toLongLong(), first.sizeInBytes());
+
+    // hits hand out the very same image
+    const quint64 hits = consumer().value(QStringLiteral("hits")).toULongLong();
+    QCOMPARE(svg.image(QSize(32, 32)).cacheKey(), first.cacheKey());
+    QCOMPARE(consumer().value(QStringLiteral("hits")).toULongLong(), hits + 1);
+
+    // with room for a single image, the least recently used one goes
+    const quint64 evictions = memory().value(QStringLiteral("evictions")).toULongLong();
+    m_theme->setMemoryCacheLimit(8);
+    QVERIFY(memory().value(QStringLiteral("used")).toLongLong() <= 8 * 1024);
+    QVERIFY(!svg.image(QSize(40, 40)).isNull());
+    QCOMPARE(consumer().value(QStringLiteral("images")).toInt(), 1);
+    QVERIFY(memory().value(QStringLiteral("evictions")).toULongLong() > evictions);
+    QCOMPARE(memory().value(QStringLiteral("budget")).toLongLong(), 8 * 1024);
+
+    m_theme->setMemoryCacheLimit(0);
+    QCOMPARE(memory().value(QStringLiteral("used")).toLongLong(), 0);
+    QCOMPARE(consumer().value(QStringLiteral("images")).toInt(), 0);
+
+    m_theme->setMemoryCacheLimit(8 * 1024);
+}
+
+void ThemeTest::testSharedCacheFlush()
+{
+    // a new file, so that nothing rendered from it is in the shared cache yet
+    const QString name = QStringLiteral("widgets/flushtest");
+    const QString themeDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma/desktoptheme/testtheme");
+    QVERIFY(QDir().mkpath(themeDir + QStringLiteral("/widgets")));
+    QFile::remove(themeDir + QStringLiteral("/widgets/flushtest.svg"));
+    QVERIFY(QFile::copy(QFINDTESTDATA("data/plasma/desktoptheme/testtheme/element.svg"), themeDir + QStringLiteral("/widgets/flushtest.svg")));
+    QFile file(themeDir + QStringLiteral("/widgets/flushtest.svg"));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime));
+    file.close();
+    QTRY_VERIFY(!m_theme->imagePath(name).isEmpty());
+
+    auto shared = [this]() {
+        return m_theme->cacheStatistics().value(QStringLiteral("shared")).toMap();
+    };
+    const quint64 flushes = shared().value(QStringLiteral("flushes")).toULongLong();
+    const quint64 insertions = shared().value(QStringLiteral("insertions")).toULongLong();
+    const int queued = shared().value(QStringLiteral("queued")).toInt();
+
+    // more renderings than the writer takes in one batch, each from its own svg
+    std::vector<std::unique_ptr<Plasma::Svg>> svgs;
+    for (int i = 0; i < 40; ++i) {
+        svgs.emplace_back(new Plasma::Svg);
+        svgs.back()->setTheme(m_theme);
+        svgs.back()->setImagePath(name);
+        QVERIFY(!svgs.back()->image(QSize(20 + i, 20 + i)).isNull());
+    }
+    QCOMPARE(shared().value(QStringLiteral("queued")).toInt(), queued + 40);
+
+    // the queue empties in the background once the save timer fires
+    QTRY_COMPARE(shared().value(QStringLiteral("queued")).toInt(), 0);
+    QTRY_COMPARE(shared().value(QStringLiteral("flushes")).toULongLong(), flushes + 1);
+    QCOMPARE(shared().value(QStringLiteral("insertions")).toULongLong(), insertions + queued + 40);
+    QVERIFY(shared().value(QStringLiteral("lastFlushTime")).toLongLong() >= 0);
+
+    // what was written is found in the shared cache
+    m_theme->setMemoryCacheLimit(0);
+    const quint64 hits = shared().value(QStringLiteral("hits")).toULongLong();
+    QVERIFY(!svgs.front()->image(QSize(20, 20)).isNull());
+    QCOMPARE(shared().value(QStringLiteral("hits")).toULongLong(), hits + 1);
+    m_theme->setMemoryCacheLimit(8 * 1024);
+
+    svgs.clear();
+    QVERIFY(QFile::remove(themeDir + QStringLiteral("/widgets/flushtest.svg")));
+}
+
+void ThemeTest::testCacheSurvival()
+{
+    // an svg using the color scheme, next to element.svg which doesn't
+    const QString name = QStringLiteral("widgets/colorstest");
+    const QString themeDir = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma/desktoptheme/testtheme");
+    QVERIFY(QDir().mkpath(themeDir + QStringLiteral("/widgets")));
+    QFile file(themeDir + QStringLiteral("/widgets/colorstest.svg"));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"16\" height=\"16\">"
+               "<style type=\"text/css\" id=\"current-color-scheme\">.ColorScheme-Text{color:#232629;}</style>"
+               "<rect class=\"ColorScheme-Text\" style=\"fill:currentColor\" width=\"16\" height=\"16\"/></svg>");
+    QVERIFY(file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime));
+    file.close();
+    QTRY_VERIFY(!m_theme->imagePath(name).isEmpty());
+
+    Plasma::Svg independent;
+    independent.setTheme(m_theme);
+    independent.setImagePath(QStringLiteral("element"));
+    Plasma::Svg dependent;
+    dependent.setTheme(m_theme);
+    dependent.setImagePath(name);
+
+    auto images = [this](const QString &path) {
+        return m_theme->cacheStatistics().value(QStringLiteral("consumers")).toMap().value(path).toMap().value(QStringLiteral("images")).toInt();
+    };
+    auto memoryImages = [this]() {
+        return m_theme->cacheStatistics().value(QStringLiteral("memory")).toMap().value(QStringLiteral("images")).toInt();
+    };
+    const QString independentPath = m_theme->imagePath(QStringLiteral("element"));
+    const QString dependentPath = m_theme->imagePath(name);
+
+    const QImage kept = independent.image(QSize(24, 24));
+    QVERIFY(!kept.isNull());
+    QVERIFY(!dependent.image(QSize(24, 24)).isNull());
+    const int independentImages = images(independentPath);
+    QVERIFY(independentImages > 0);
+    QCOMPARE(images(dependentPath), 1);
+
+    // what is stored through the public API can depend on anything
+    const QString publicKey = QStringLiteral("cachesurvivaltest");
+    QPixmap publicPixmap(8, 8);
+    publicPixmap.fill(Qt::red);
+    QPixmap found;
+    m_theme->insertIntoCache(publicKey, publicPixmap);
+    QVERIFY(m_theme->findInCache(publicKey, found, 1));
+    const int before = memoryImages();
+
+    QSignalSpy themeChangedSpy(m_theme, &Plasma::Theme::themeChanged);
+    QVERIFY(themeChangedSpy.isValid());
+    QEvent event(QEvent::ApplicationPaletteChange);
+    QCoreApplication::sendEvent(QCoreApplication::instance(), &event);
+    QVERIFY(themeChangedSpy.wait());
+
+    // a change of colors only drops what was rendered with them, and the public images
+    QCOMPARE(images(dependentPath), 0);
+    QCOMPARE(images(independentPath), independentImages);
+    QCOMPARE(memoryImages(), before - 2);
+    QVERIFY(!m_theme->findInCache(publicKey, found, 1));
+    QCOMPARE(independent.image(QSize(24, 24)).cacheKey(), kept.cacheKey());
+    QVERIFY(!dependent.image(QSize(24, 24)).isNull());
+    QCOMPARE(images(dependentPath), 1);
+
+#if HAVE_X11
+    if (KWindowSystem::isPlatformX11()) {
+        // toggling compositing keeps the renderings of each variant, but not the public images
+        const QImage opaque = independent.image(QSize(24, 24));
+        m_theme->insertIntoCache(publicKey, publicPixmap);
+        QVERIFY(m_theme->findInCache(publicKey, found, 1));
+
+        themeChangedSpy.clear();
+        QScopedPointer<KSelectionOwner> compositorSelection(new KSelectionOwner("_NET_WM_CM_S0"));
+        QSignalSpy claimedSpy(compositorSelection.data(), &KSelectionOwner::claimedOwnership);
+        QVERIFY(claimedSpy.isValid());
+        compositorSelection->claim(true);
+        QVERIFY(claimedSpy.wait());
+        QVERIFY(themeChangedSpy.wait());
+        QVERIFY(!m_theme->findInCache(publicKey, found, 1));
+
+        compositorSelection.reset();
+        QVERIFY(themeChangedSpy.wait());
+        QVERIFY(!m_theme->findInCache(publicKey, found, 1));
+        QCOMPARE(independent.image(QSize(24, 24)).cacheKey(), opaque.cacheKey());
+    }
+#endif
+
+    QVERIFY(QFile::remove(themeDir + QStringLiteral("/widgets/colorstest.svg")));
+}
+
 QTEST_MAIN(ThemeTest)
 
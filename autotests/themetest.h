@@ -22,7 +22,13 @@ public Q_SLOTS:
 private Q_SLOTS:
     void loadSvgIcon();
     void testColors();
+    void testPaletteChangeBatching();
     void testCompositingChange();
+    void testImagePathManifest();
+    void testWallpaperBestFit();
+    void testImageCacheStatistics();
+    void testSharedCacheFlush();
+    void testCacheSurvival();
 
 private:
     Plasma::Svg *m_svg;
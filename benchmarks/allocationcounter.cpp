@@ -0,0 +1,78 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+
+static std::atomic<bool> s_counting(false);
+static std::atomic<quint64> s_allocations(0);
+
+#if defined(__GLIBC__)
+// glibc lets the executable interpose its allocator and still reach the
+// real one, which catches Qt's own allocations and not just operator new
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed)) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed)) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed)) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace Plasma {
+namespace BenchmarkUtils {
+
+AllocationCounter::AllocationCounter()
+    : m_start(s_allocations.load())
+{
+    s_counting = true;
+}
+
+AllocationCounter::~AllocationCounter()
+{
+    s_counting = false;
+}
+
+bool AllocationCounter::isSupported()
+{
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+quint64 AllocationCounter::count() const
+{
+    return s_allocations.load() - m_start;
+}
+
+} //BenchmarkUtils
+} //Plasma
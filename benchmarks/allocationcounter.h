@@ -0,0 +1,39 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+namespace Plasma {
+namespace BenchmarkUtils {
+
+/**
+ * Counts the heap allocations made by the process while it is alive.
+ * Only one counter should be alive at a time.
+ */
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    /**
+     * @return whether allocations can be counted on this platform,
+     * when they can't count() is always 0
+     */
+    static bool isSupported();
+
+    quint64 count() const;
+
+private:
+    quint64 m_start;
+};
+
+} //BenchmarkUtils
+} //Plasma
+
+#endif
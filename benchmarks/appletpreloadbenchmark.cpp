@@ -0,0 +1,170 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "appletpreloadbenchmark.h"
+#include "benchmarkutils.h"
+
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QTimer>
+
+#include <KConfigGroup>
+#include <KPackage/Package>
+#include <KPackage/PackageStructure>
+#include <kdeclarative/qmlobject.h>
+
+#include "plasma/containment.h"
+
+#include <algorithm>
+
+// the same set of applets for every run, as in a panel of a typical session
+static const int s_applets = 20;
+
+class PreloadPackageStructure : public KPackage::PackageStructure
+{
+public:
+    void initPackage(KPackage::Package *package) override
+    {
+        package->addDirectoryDefinition("ui", QStringLiteral("ui"), QStringLiteral("User Interface"));
+        package->addFileDefinition("mainscript", QStringLiteral("ui/main.qml"), QStringLiteral("Main Script File"));
+        package->setRequired("mainscript", true);
+    }
+};
+
+class PreloadApplet : public Plasma::Applet
+{
+public:
+    PreloadApplet(const KPackage::Package &package, uint appletId)
+        : Plasma::Applet(nullptr, {QVariant::fromValue(package), QVariant(), appletId})
+    {
+    }
+};
+
+Plasma::Applet *PreloadLoader::internalLoadApplet(const QString &name, uint appletId, const QVariantList &args)
+{
+    Q_UNUSED(args)
+    if (name != QLatin1String("preloadapplet")) {
+        return nullptr;
+    }
+
+    static PreloadPackageStructure structure;
+    KPackage::Package package(&structure);
+    package.setPath(QFINDTESTDATA("data/preloadapplet"));
+    return new PreloadApplet(package, appletId);
+}
+
+PreloadCorona::PreloadCorona(QObject *parent)
+    : Plasma::Corona(parent)
+{
+}
+
+QRect PreloadCorona::screenGeometry(int id) const
+{
+    Q_UNUSED(id)
+    return QRect(0, 0, 1920, 1080);
+}
+
+PreloadQuickItem::PreloadQuickItem(Plasma::Applet *applet, QQuickItem *parent)
+    : PlasmaQuick::AppletQuickItem(applet, parent)
+{
+}
+
+void PreloadQuickItem::init()
+{
+    QQmlEngine *engine = qmlObject()->engine();
+    const KPackage::Package package = applet()->kPackage();
+
+    setCompactRepresentation(new QQmlComponent(engine, QUrl::fromLocalFile(package.filePath("ui", QStringLiteral("CompactRepresentation.qml"))), this));
+    setFullRepresentation(new QQmlComponent(engine, QUrl::fromLocalFile(package.filePath("ui", QStringLiteral("FullRepresentation.qml"))), this));
+
+    AppletQuickItem::init();
+}
+
+void AppletPreloadBenchmark::initTestCase()
+{
+    // the default, adaptive, policy
+    qunsetenv("PLASMA_PRELOAD_POLICY");
+    Plasma::PluginLoader::setPluginLoader(new PreloadLoader);
+}
+
+QVector<PreloadQuickItem *> AppletPreloadBenchmark::loadPanel(Plasma::Corona *corona, int preloadWeight)
+{
+    Plasma::Containment *panel = corona->createContainment(QStringLiteral("null"));
+    panel->setFormFactor(Plasma::Types::Horizontal);
+
+    // as the shell does while restoring a layout: all the items are
+    // initialized before the panel reports its ui as ready
+    QVector<PreloadQuickItem *> items;
+    for (int i = 0; i < s_applets; ++i) {
+        Plasma::Applet *applet = panel->createApplet(QStringLiteral("preloadapplet"));
+        applet->config().writeEntry("PreloadWeight", preloadWeight);
+
+        PreloadQuickItem *item = new PreloadQuickItem(applet);
+        item->init();
+        items << item;
+    }
+
+    QDeadlineTimer deadline(5000);
+    while (!panel->isUiReady() && !deadline.hasExpired()) {
+        QCoreApplication::processEvents();
+    }
+    return items;
+}
+
+void AppletPreloadBenchmark::startup_data()
+{
+    QTest::addColumn<int>("preloadWeight");
+
+    QTest::newRow("popups preloaded") << 50;
+    QTest::newRow("popups not preloaded") << 0;
+}
+
+void AppletPreloadBenchmark::startup()
+{
+    QFETCH(int, preloadWeight);
+
+    // the popups are queued, so the startup shouldn't pay for any of them
+    QBENCHMARK {
+        PreloadCorona corona;
+        const QVector<PreloadQuickItem *> items = loadPanel(&corona, preloadWeight);
+        const bool uiReady = items.first()->applet()->containment()->isUiReady();
+        qDeleteAll(items);
+        QVERIFY(uiReady);
+    }
+}
+
+void AppletPreloadBenchmark::preloadStalls()
+{
+    PreloadCorona corona;
+    const QVector<PreloadQuickItem *> items = loadPanel(&corona, 50);
+    QVERIFY(items.first()->applet()->containment()->isUiReady());
+
+    auto allPreloaded = [&items]() {
+        return std::all_of(items.cbegin(), items.cend(), [](PreloadQuickItem *item) {
+            return item->fullRepresentationItem();
+        });
+    };
+
+    // the longest the event loop gets blocked while the popups are
+    // loaded in the background: what the user perceives as a freeze
+    QElapsedTimer sinceLastTick;
+    qint64 longestStall = 0;
+    QTimer heartbeat;
+    connect(&heartbeat, &QTimer::timeout, this, [&sinceLastTick, &longestStall]() {
+        longestStall = std::max(longestStall, sinceLastTick.restart());
+    });
+    sinceLastTick.start();
+    heartbeat.start(0);
+
+    QTRY_VERIFY_WITH_TIMEOUT(allPreloaded(), 30000);
+    QTest::setBenchmarkResult(longestStall, QTest::WalltimeMilliseconds);
+
+    qDeleteAll(items);
+}
+
+PLASMA_BENCHMARK_MAIN(AppletPreloadBenchmark)
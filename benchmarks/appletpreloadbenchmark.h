@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef APPLETPRELOADBENCHMARK_H
+#define APPLETPRELOADBENCHMARK_H
+
+#include <QTest>
+
+#include "plasma/corona.h"
+#include "plasma/pluginloader.h"
+
+#include "plasmaquick/appletquickitem.h"
+
+// Serves the applet of the benchmark package, with no script engine, so
+// only the work of the quick items is measured
+class PreloadLoader : public Plasma::PluginLoader
+{
+protected:
+    Plasma::Applet *internalLoadApplet(const QString &name, uint appletId = 0, const QVariantList &args = QVariantList()) override;
+};
+
+class PreloadCorona : public Plasma::Corona
+{
+    Q_OBJECT
+
+public:
+    explicit PreloadCorona(QObject *parent = nullptr);
+
+    QRect screenGeometry(int id) const override;
+};
+
+// A panel applet with the compact and full representations of its package,
+// the latter being what gets preloaded
+class PreloadQuickItem : public PlasmaQuick::AppletQuickItem
+{
+    Q_OBJECT
+
+public:
+    explicit PreloadQuickItem(Plasma::Applet *applet, QQuickItem *parent = nullptr);
+
+    void init() override;
+};
+
+class AppletPreloadBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+
+private Q_SLOTS:
+    void startup_data();
+    void startup();
+    void preloadStalls();
+
+private:
+    QVector<PreloadQuickItem *> loadPanel(Plasma::Corona *corona, int preloadWeight);
+};
+
+#endif
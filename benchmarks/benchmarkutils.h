@@ -0,0 +1,50 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef BENCHMARKUTILS_H
+#define BENCHMARKUTILS_H
+
+#include <QApplication>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "utils.h"
+
+namespace Plasma {
+namespace BenchmarkUtils {
+
+// Starts every benchmark from an empty cache, so the first run of a
+// cold benchmark really measures the work of filling it
+static void clearCaches()
+{
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)).removeRecursively();
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).removeRecursively();
+}
+
+} //BenchmarkUtils
+} //Plasma
+
+// The benchmarks always run on the offscreen platform, with the software
+// scene graph and the test mode paths, so their numbers don't depend on the
+// session, the GPU or the configuration of the user running them
+#define PLASMA_BENCHMARK_MAIN(BenchmarkObject) \
+int main(int argc, char *argv[]) \
+{ \
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) { \
+        qputenv("QT_QPA_PLATFORM", "offscreen"); \
+    } \
+    if (qEnvironmentVariableIsEmpty("QT_QUICK_BACKEND")) { \
+        qputenv("QT_QUICK_BACKEND", "software"); \
+    } \
+    QStandardPaths::setTestModeEnabled(true); \
+    QCoreApplication::setAttribute(Qt::AA_Use96Dpi, true); \
+    QApplication app(argc, argv); \
+    BenchmarkObject benchmark; \
+    QTEST_SET_MAIN_SOURCE_PATH \
+    return QTest::qExec(&benchmark, argc, argv); \
+}
+
+#endif
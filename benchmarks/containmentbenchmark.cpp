@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "containmentbenchmark.h"
+#include "benchmarkutils.h"
+
+#include "appletgeometryindex.h"
+
+BenchmarkCorona::BenchmarkCorona(QObject *parent)
+    : Plasma::Corona(parent)
+{
+}
+
+QRect BenchmarkCorona::screenGeometry(int id) const
+{
+    Q_UNUSED(id)
+    return QRect(0, 0, 1920, 1080);
+}
+
+QRegion BenchmarkCorona::availableScreenRegion(int id) const
+{
+    // a bottom panel, a centered top panel and a left dock,
+    // enough to split the screen in several bands
+    QRegion region(screenGeometry(id));
+    region -= QRect(0, 1036, 1920, 44);
+    region -= QRect(560, 0, 800, 32);
+    region -= QRect(0, 300, 64, 480);
+    return region;
+}
+
+void ContainmentBenchmark::initTestCase()
+{
+    // a desktop full of applets, in a 25 x 20 grid
+    m_root = new QQuickItem();
+    m_root->setSize(QSizeF(1920, 1080));
+    for (int i = 0; i < 500; ++i) {
+        QQuickItem *applet = new QQuickItem(m_root);
+        applet->setPosition(QPointF((i % 25) * 76, (i / 25) * 54));
+        applet->setSize(QSizeF(64, 48));
+        m_applets << applet;
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        m_points << QPointF((i * 173) % 1920, (i * 97) % 1080);
+        m_rects << QRect((i * 173) % 1800, (i * 97) % 980, 120, 100);
+    }
+
+    m_corona = new BenchmarkCorona(this);
+}
+
+void ContainmentBenchmark::cleanupTestCase()
+{
+    delete m_root;
+}
+
+void ContainmentBenchmark::hitTestLinear()
+{
+    // what the containment did before having an index
+    QBENCHMARK {
+        for (const QPointF &pos : qAsConst(m_points)) {
+            for (QQuickItem *applet : qAsConst(m_applets)) {
+                if (applet->contains(applet->mapFromItem(m_root, pos))) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void ContainmentBenchmark::hitTestIndex()
+{
+    AppletGeometryIndex index(m_root);
+    for (QQuickItem *applet : qAsConst(m_applets)) {
+        index.insert(applet);
+    }
+    QCOMPARE(index.itemAt(QPointF(1, 1)), m_applets.first());
+
+    QBENCHMARK {
+        for (const QPointF &pos : qAsConst(m_points)) {
+            index.itemAt(pos);
+        }
+    }
+}
+
+void ContainmentBenchmark::availableRegionIntersected()
+{
+    QBENCHMARK {
+        for (const QRect &rect : qAsConst(m_rects)) {
+            const QRegion region = m_corona->availableScreenRegion(0);
+            if (region.intersected(rect) == QRegion(rect)) {
+                continue;
+            }
+        }
+    }
+}
+
+void ContainmentBenchmark::availableRegionContains()
+{
+    for (const QRect &rect : qAsConst(m_rects)) {
+        QCOMPARE(m_corona->availableScreenRegionContains(0, rect),
+                 m_corona->availableScreenRegion(0).intersected(rect) == QRegion(rect));
+    }
+
+    QBENCHMARK {
+        for (const QRect &rect : qAsConst(m_rects)) {
+            m_corona->availableScreenRegionContains(0, rect);
+        }
+    }
+}
+
+PLASMA_BENCHMARK_MAIN(ContainmentBenchmark)
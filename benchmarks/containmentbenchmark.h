@@ -0,0 +1,47 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef CONTAINMENTBENCHMARK_H
+#define CONTAINMENTBENCHMARK_H
+
+#include <QQuickItem>
+#include <QTest>
+
+#include "plasma/corona.h"
+
+class BenchmarkCorona : public Plasma::Corona
+{
+    Q_OBJECT
+
+public:
+    explicit BenchmarkCorona(QObject *parent = nullptr);
+
+    QRect screenGeometry(int id) const override;
+    QRegion availableScreenRegion(int id) const override;
+};
+
+class ContainmentBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+private Q_SLOTS:
+    void hitTestLinear();
+    void hitTestIndex();
+    void availableRegionIntersected();
+    void availableRegionContains();
+
+private:
+    QQuickItem *m_root = nullptr;
+    QVector<QQuickItem *> m_applets;
+    QVector<QPointF> m_points;
+    QVector<QRect> m_rects;
+    BenchmarkCorona *m_corona = nullptr;
+};
+
+#endif
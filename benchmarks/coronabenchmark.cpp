@@ -0,0 +1,109 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "coronabenchmark.h"
+#include "benchmarkutils.h"
+
+#include <KConfigGroup>
+
+#include "plasma/containment.h"
+
+static const int s_screens = 2;
+static const int s_appletsPerContainment = 20;
+
+Plasma::Applet *StartupLoader::internalLoadApplet(const QString &name, uint appletId, const QVariantList &args)
+{
+    Q_UNUSED(args)
+    if (name == QLatin1String("startupcontainment")) {
+        return new Plasma::Containment(nullptr, QString(), appletId);
+    } else if (name == QLatin1String("startupapplet")) {
+        return new Plasma::Applet(nullptr, QString(), appletId);
+    }
+    return nullptr;
+}
+
+StartupCorona::StartupCorona(QObject *parent)
+    : Plasma::Corona(parent)
+{
+}
+
+QRect StartupCorona::screenGeometry(int id) const
+{
+    if (id != 0) {
+        return QRect();
+    }
+    return QRect(0, 0, 1920, 1080);
+}
+
+static QString layoutName(int activities)
+{
+    return QStringLiteral("coronabenchmark-%1-appletsrc").arg(activities);
+}
+
+static void writeContainment(KConfigGroup &containments, uint &id, int screen, const QString &activity)
+{
+    KConfigGroup containment(&containments, QString::number(++id));
+    containment.writeEntry("plugin", "startupcontainment");
+    containment.writeEntry("lastScreen", screen);
+    containment.writeEntry("activityId", activity);
+
+    KConfigGroup applets(&containment, "Applets");
+    for (int i = 0; i < s_appletsPerContainment; ++i) {
+        KConfigGroup applet(&applets, QString::number(++id));
+        applet.writeEntry("plugin", "startupapplet");
+        KConfigGroup(&applet, "Configuration").writeEntry("setting", i);
+    }
+}
+
+// a panel on each screen, and a desktop on each screen for every activity
+static void writeLayout(int activities)
+{
+    KSharedConfigPtr layout = KSharedConfig::openConfig(layoutName(activities), KConfig::SimpleConfig);
+    KConfigGroup containments(layout, "Containments");
+    containments.deleteGroup();
+
+    uint id = 0;
+    for (int screen = 0; screen < s_screens; ++screen) {
+        writeContainment(containments, id, screen, QString());
+        for (int activity = 0; activity < activities; ++activity) {
+            writeContainment(containments, id, screen, QStringLiteral("activity-%1").arg(activity));
+        }
+    }
+    layout->sync();
+}
+
+void CoronaBenchmark::initTestCase()
+{
+    Plasma::PluginLoader::setPluginLoader(new StartupLoader);
+}
+
+void CoronaBenchmark::loadLayout_data()
+{
+    QTest::addColumn<int>("activities");
+    QTest::addColumn<bool>("deferred");
+
+    for (int activities : {1, 10, 50}) {
+        QTest::addRow("%d activities, all loaded", activities) << activities << false;
+        QTest::addRow("%d activities, deferred", activities) << activities << true;
+    }
+}
+
+void CoronaBenchmark::loadLayout()
+{
+    QFETCH(int, activities);
+    QFETCH(bool, deferred);
+
+    writeLayout(activities);
+
+    QBENCHMARK {
+        StartupCorona corona;
+        corona.setDeferredLoadingEnabled(deferred);
+        corona.setRunningActivities({QStringLiteral("activity-0")});
+        corona.loadLayout(layoutName(activities));
+    }
+}
+
+PLASMA_BENCHMARK_MAIN(CoronaBenchmark)
@@ -0,0 +1,45 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef CORONABENCHMARK_H
+#define CORONABENCHMARK_H
+
+#include <QTest>
+
+#include "plasma/corona.h"
+#include "plasma/pluginloader.h"
+
+// Serves plain containments and applets, so the benchmark measures the
+// restore of the layout rather than the loading of plugins
+class StartupLoader : public Plasma::PluginLoader
+{
+protected:
+    Plasma::Applet *internalLoadApplet(const QString &name, uint appletId = 0, const QVariantList &args = QVariantList()) override;
+};
+
+// A session with only the first screen connected
+class StartupCorona : public Plasma::Corona
+{
+    Q_OBJECT
+
+public:
+    explicit StartupCorona(QObject *parent = nullptr);
+
+    QRect screenGeometry(int id) const override;
+};
+
+class CoronaBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+
+private Q_SLOTS:
+    void loadLayout_data();
+    void loadLayout();
+};
+
+#endif
@@ -0,0 +1,12 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+import QtQuick 2.0
+
+Rectangle {
+    width: 32
+    height: 32
+    color: "darkblue"
+}
@@ -0,0 +1,29 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+import QtQuick 2.0
+
+// a popup of about the size of the ones of the default applets
+Column {
+    width: 300
+    height: 400
+
+    Repeater {
+        model: 50
+        delegate: Row {
+            width: 300
+            height: 24
+            spacing: 4
+            Rectangle {
+                width: 24
+                height: 24
+                color: index % 2 ? "darkblue" : "darkgreen"
+            }
+            Text {
+                text: "Entry " + index
+            }
+        }
+    }
+}
@@ -0,0 +1,247 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "dataenginebenchmark.h"
+#include "allocationcounter.h"
+#include "benchmarkutils.h"
+
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+
+#include "datamodel.h"
+#include "datasource.h"
+
+Q_DECLARE_METATYPE(LoadEngine::Profile)
+
+// Runs the event loop until the data set so far reached the consumers
+static void deliverUpdates()
+{
+    // the engine notifies its consumers from a 0 ms timer
+    QCoreApplication::processEvents();
+    QCoreApplication::sendPostedEvents();
+}
+
+static void setupDataSource(Plasma::DataSource *source, const QStringList &sources)
+{
+    source->classBegin();
+    source->setEngine(QStringLiteral("load"));
+    source->setConnectedSources(sources);
+    source->componentComplete();
+}
+
+void DataEngineBenchmark::initTestCase()
+{
+    // like in a shell, the loader lives as long as the process
+    Plasma::PluginLoader::setPluginLoader(new LoadEngineLoader);
+
+    m_engine = qobject_cast<LoadEngine *>(m_consumer.dataEngine(QStringLiteral("load")));
+    QVERIFY(m_engine);
+    QVERIFY(m_engine->isValid());
+}
+
+void DataEngineBenchmark::addProfiles()
+{
+    QTest::addColumn<LoadEngine::Profile>("profile");
+
+    LoadEngine::Profile monitor;
+    monitor.sources = 200;
+    monitor.keysPerSource = 8;
+    monitor.payload = LoadEngine::Numbers;
+    QTest::newRow("system monitor") << monitor;
+
+    LoadEngine::Profile processes;
+    processes.sources = 2000;
+    processes.keysPerSource = 4;
+    processes.payload = LoadEngine::Strings;
+    QTest::newRow("process list") << processes;
+
+    LoadEngine::Profile notifications;
+    notifications.sources = 20;
+    notifications.keysPerSource = 1;
+    notifications.payload = LoadEngine::Maps;
+    QTest::newRow("notifications") << notifications;
+
+    LoadEngine::Profile plots;
+    plots.sources = 50;
+    plots.keysPerSource = 4;
+    plots.payload = LoadEngine::Lists;
+    QTest::newRow("plotters") << plots;
+}
+
+void DataEngineBenchmark::guiTimePerRound_data()
+{
+    addProfiles();
+}
+
+void DataEngineBenchmark::guiTimePerRound()
+{
+    QFETCH(LoadEngine::Profile, profile);
+    m_engine->setProfile(profile);
+
+    Plasma::DataSource source;
+    setupDataSource(&source, m_engine->sourceNames());
+    deliverUpdates();
+
+    // everything happens in the gui thread: from setData to the DataSource property map
+    QBENCHMARK {
+        m_engine->updateRound();
+        deliverUpdates();
+    }
+}
+
+void DataEngineBenchmark::updatesPerSecond_data()
+{
+    addProfiles();
+}
+
+void DataEngineBenchmark::updatesPerSecond()
+{
+    QFETCH(LoadEngine::Profile, profile);
+    m_engine->setProfile(profile);
+
+    Plasma::DataSource source;
+    setupDataSource(&source, m_engine->sourceNames());
+    deliverUpdates();
+
+    qint64 delivered = 0;
+    connect(&source, &Plasma::DataSource::newData, this, [&delivered](const QString &, const QVariantMap &data) {
+        delivered += data.count();
+    });
+
+    // the reported number of events is the number of values delivered in one second
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 1000) {
+        m_engine->updateRound();
+        deliverUpdates();
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    QVERIFY(delivered > 0);
+    QTest::setBenchmarkResult(qreal(delivered) * 1e9 / elapsed, QTest::Events);
+}
+
+void DataEngineBenchmark::allocationsPerUpdate_data()
+{
+    addProfiles();
+}
+
+void DataEngineBenchmark::allocationsPerUpdate()
+{
+    if (!Plasma::BenchmarkUtils::AllocationCounter::isSupported()) {
+        QSKIP("Allocations can't be counted on this platform");
+    }
+
+    QFETCH(LoadEngine::Profile, profile);
+    m_engine->setProfile(profile);
+
+    Plasma::DataSource source;
+    setupDataSource(&source, m_engine->sourceNames());
+    deliverUpdates();
+
+    // a round to warm up the containers and the property map
+    m_engine->updateRound();
+    deliverUpdates();
+
+    const int rounds = 10;
+    const qint64 valuesBefore = m_engine->valuesSet();
+    quint64 allocations = 0;
+    {
+        Plasma::BenchmarkUtils::AllocationCounter counter;
+        for (int i = 0; i < rounds; ++i) {
+            m_engine->updateRound();
+            deliverUpdates();
+        }
+        allocations = counter.count();
+    }
+    const qint64 values = m_engine->valuesSet() - valuesBefore;
+
+    QTest::setBenchmarkResult(qreal(allocations) / values, QTest::Events);
+}
+
+void DataEngineBenchmark::latencyToModel_data()
+{
+    addProfiles();
+}
+
+void DataEngineBenchmark::latencyToModel()
+{
+    QFETCH(LoadEngine::Profile, profile);
+    m_engine->setProfile(profile);
+
+    Plasma::DataSource source;
+    setupDataSource(&source, m_engine->sourceNames());
+    deliverUpdates();
+
+    Plasma::DataModel model;
+    model.setDataSource(&source);
+    model.setKeyRoleFilter(QStringLiteral(".*"));
+
+    // connected after the model, so it runs once the model has been updated
+    bool reachedModel = false;
+    connect(&source, &Plasma::DataSource::newData, this, [&reachedModel]() {
+        reachedModel = true;
+    });
+
+    const int updates = 100;
+    qint64 latency = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < updates; ++i) {
+        reachedModel = false;
+        timer.start();
+        m_engine->updateSource(i % profile.sources);
+        // an update that never arrives fails the run instead of hanging it
+        const QDeadlineTimer deadline(5000);
+        while (!reachedModel && !deadline.hasExpired()) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+        }
+        QVERIFY2(reachedModel, "the update didn't reach the model in time");
+        latency += timer.nsecsElapsed();
+    }
+
+    QVERIFY(model.count() > 0);
+    QTest::setBenchmarkResult(qreal(latency) / updates, QTest::WalltimeNanoseconds);
+}
+
+void DataEngineBenchmark::connectManySources()
+{
+    LoadEngine::Profile profile;
+    profile.sources = 5000;
+    m_engine->setProfile(profile);
+
+    const QStringList all = m_engine->sourceNames();
+    const QStringList firstHalf = all.mid(0, 2500);
+    const QStringList secondHalf = all.mid(2500);
+
+    Plasma::DataSource source;
+    setupDataSource(&source, QStringList());
+
+    // what a task manager or process list does when its filter changes
+    QBENCHMARK {
+        source.setConnectedSources(all);
+        source.setConnectedSources(firstHalf);
+        source.setConnectedSources(secondHalf);
+        source.setConnectedSources(QStringList());
+    }
+}
+
+void DataEngineBenchmark::retimeManySources()
+{
+    LoadEngine::Profile profile;
+    profile.sources = 5000;
+    m_engine->setProfile(profile);
+
+    Plasma::DataSource source;
+    setupDataSource(&source, m_engine->sourceNames());
+
+    int interval = 1000;
+    QBENCHMARK {
+        interval = interval == 1000 ? 2000 : 1000;
+        source.setInterval(interval);
+    }
+}
+
+PLASMA_BENCHMARK_MAIN(DataEngineBenchmark)
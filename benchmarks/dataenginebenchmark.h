@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef DATAENGINEBENCHMARK_H
+#define DATAENGINEBENCHMARK_H
+
+#include <QTest>
+
+#include "plasma/dataengineconsumer.h"
+
+#include "loadengine.h"
+
+class DataEngineBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+
+private Q_SLOTS:
+    void guiTimePerRound_data();
+    void guiTimePerRound();
+    void updatesPerSecond_data();
+    void updatesPerSecond();
+    void allocationsPerUpdate_data();
+    void allocationsPerUpdate();
+    void latencyToModel_data();
+    void latencyToModel();
+    void connectManySources();
+    void retimeManySources();
+
+private:
+    void addProfiles();
+
+    Plasma::DataEngineConsumer m_consumer;
+    LoadEngine *m_engine = nullptr;
+};
+
+#endif
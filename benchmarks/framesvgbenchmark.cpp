@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "framesvgbenchmark.h"
+#include "benchmarkutils.h"
+
+#include "plasma/theme.h"
+
+void FrameSvgBenchmark::initTestCase()
+{
+    Plasma::BenchmarkUtils::clearCaches();
+    Plasma::TestUtils::installPlasmaTheme("breeze");
+    Plasma::Theme().setThemeName(QStringLiteral("default"));
+
+    // what a panel or a popup goes through while being resized by the user
+    for (int i = 0; i < 32; ++i) {
+        m_sizes << QSizeF(100 + i * 7, 40 + i * 3);
+    }
+}
+
+void FrameSvgBenchmark::resizeSweepCold()
+{
+    Plasma::FrameSvg frameSvg;
+    frameSvg.setImagePath(QStringLiteral("widgets/background"));
+    frameSvg.setUsingRenderingCache(false);
+
+    QBENCHMARK {
+        frameSvg.clearCache();
+        for (const QSizeF &size : qAsConst(m_sizes)) {
+            frameSvg.resizeFrame(size);
+            frameSvg.framePixmap();
+        }
+    }
+}
+
+void FrameSvgBenchmark::resizeSweepWarm()
+{
+    Plasma::FrameSvg frameSvg;
+    frameSvg.setImagePath(QStringLiteral("widgets/background"));
+    frameSvg.setCacheAllRenderedFrames(true);
+
+    for (const QSizeF &size : qAsConst(m_sizes)) {
+        frameSvg.resizeFrame(size);
+        QVERIFY(!frameSvg.framePixmap().isNull());
+    }
+
+    QBENCHMARK {
+        for (const QSizeF &size : qAsConst(m_sizes)) {
+            frameSvg.resizeFrame(size);
+            frameSvg.framePixmap();
+        }
+    }
+}
+
+void FrameSvgBenchmark::enabledBorders()
+{
+    Plasma::FrameSvg frameSvg;
+    frameSvg.setImagePath(QStringLiteral("widgets/panel-background"));
+    frameSvg.resizeFrame(QSizeF(400, 48));
+
+    const QVector<Plasma::FrameSvg::EnabledBorders> borders = {
+        Plasma::FrameSvg::AllBorders,
+        Plasma::FrameSvg::TopBorder | Plasma::FrameSvg::LeftBorder | Plasma::FrameSvg::RightBorder,
+        Plasma::FrameSvg::TopBorder,
+        Plasma::FrameSvg::NoBorder,
+    };
+
+    // a panel touching and leaving the screen edges
+    QBENCHMARK {
+        for (const auto border : borders) {
+            frameSvg.setEnabledBorders(border);
+            frameSvg.marginSize(Plasma::Types::TopMargin);
+        }
+    }
+}
+
+void FrameSvgBenchmark::prefixSwitch()
+{
+    Plasma::FrameSvg frameSvg;
+    frameSvg.setImagePath(QStringLiteral("widgets/panel-background"));
+    frameSvg.resizeFrame(QSizeF(400, 48));
+    QVERIFY(frameSvg.hasElementPrefix(QStringLiteral("shadow")));
+
+    const QStringList prefixes = {QString(), QStringLiteral("shadow"), QStringLiteral("mask")};
+
+    QBENCHMARK {
+        for (const QString &prefix : prefixes) {
+            frameSvg.setElementPrefix(prefix);
+            frameSvg.marginSize(Plasma::Types::LeftMargin);
+        }
+    }
+}
+
+void FrameSvgBenchmark::margins()
+{
+    Plasma::FrameSvg frameSvg;
+    frameSvg.setImagePath(QStringLiteral("widgets/background"));
+    frameSvg.resizeFrame(QSizeF(200, 200));
+
+    qreal left, top, right, bottom;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            frameSvg.getMargins(left, top, right, bottom);
+            frameSvg.contentsRect();
+        }
+    }
+}
+
+PLASMA_BENCHMARK_MAIN(FrameSvgBenchmark)
@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef FRAMESVGBENCHMARK_H
+#define FRAMESVGBENCHMARK_H
+
+#include <QTest>
+
+#include "plasma/framesvg.h"
+
+class FrameSvgBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+
+private Q_SLOTS:
+    void resizeSweepCold();
+    void resizeSweepWarm();
+    void enabledBorders();
+    void prefixSwitch();
+    void margins();
+
+private:
+    QVector<QSizeF> m_sizes;
+};
+
+#endif
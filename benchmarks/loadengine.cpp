@@ -0,0 +1,158 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "loadengine.h"
+
+#include <QJsonObject>
+
+#include <KPluginMetaData>
+
+static KPluginMetaData loadEngineMetaData()
+{
+    const QJsonObject plugin {
+        {QStringLiteral("Id"), QStringLiteral("load")},
+        {QStringLiteral("Name"), QStringLiteral("Load")},
+    };
+    return KPluginMetaData(QJsonObject {{QStringLiteral("KPlugin"), plugin}}, QString());
+}
+
+LoadEngine::LoadEngine(QObject *parent)
+    : Plasma::DataEngine(loadEngineMetaData(), parent)
+{
+    connect(&m_timer, &QTimer::timeout, this, &LoadEngine::updateRound);
+    setProfile(Profile());
+}
+
+LoadEngine::~LoadEngine()
+{
+}
+
+void LoadEngine::setProfile(const Profile &profile)
+{
+    removeAllSources();
+
+    m_profile = profile;
+    m_round = 0;
+    m_valuesSet = 0;
+    m_timer.setInterval(profile.updateInterval);
+
+    // names are made once, the rounds measure the pipeline and not QString::arg
+    m_sourceNames.clear();
+    m_sourceIndexes.clear();
+    for (int i = 0; i < profile.sources; ++i) {
+        const QString name = QStringLiteral("source%1").arg(i);
+        m_sourceNames << name;
+        m_sourceIndexes[name] = i;
+    }
+    m_keys.clear();
+    for (int i = 0; i < profile.keysPerSource; ++i) {
+        m_keys << QStringLiteral("key%1").arg(i);
+    }
+
+    for (int i = 0; i < profile.sources; ++i) {
+        updateSource(i);
+    }
+    m_valuesSet = 0;
+}
+
+LoadEngine::Profile LoadEngine::profile() const
+{
+    return m_profile;
+}
+
+QStringList LoadEngine::sourceNames() const
+{
+    return m_sourceNames;
+}
+
+void LoadEngine::updateRound()
+{
+    ++m_round;
+    for (int i = 0; i < m_sourceNames.count(); ++i) {
+        updateSource(i);
+    }
+}
+
+void LoadEngine::updateSource(int source)
+{
+    Plasma::DataEngine::Data data;
+    for (int key = 0; key < m_keys.count(); ++key) {
+        data.insert(m_keys.at(key), value(source, key));
+    }
+    setData(m_sourceNames.at(source), data);
+    m_valuesSet += m_keys.count();
+}
+
+void LoadEngine::start()
+{
+    m_timer.start();
+}
+
+void LoadEngine::stop()
+{
+    m_timer.stop();
+}
+
+qint64 LoadEngine::valuesSet() const
+{
+    return m_valuesSet;
+}
+
+bool LoadEngine::sourceRequestEvent(const QString &source)
+{
+    // all the sources exist from the start
+    Q_UNUSED(source)
+    return false;
+}
+
+bool LoadEngine::updateSourceEvent(const QString &source)
+{
+    // polled sources get a new value at every poll
+    const auto it = m_sourceIndexes.constFind(source);
+    if (it == m_sourceIndexes.constEnd()) {
+        return false;
+    }
+    updateSource(*it);
+    return true;
+}
+
+QVariant LoadEngine::value(int source, int key) const
+{
+    const int seed = m_round + source + key;
+
+    switch (m_profile.payload) {
+    case Numbers:
+        return double(seed % 100) + 0.5;
+    case Strings:
+        return QString(QStringLiteral("value ") + QString::number(seed));
+    case Maps:
+        return QVariantMap {
+            {QStringLiteral("appName"), QStringLiteral("Load")},
+            {QStringLiteral("summary"), QString(QStringLiteral("Notification ") + QString::number(seed))},
+            {QStringLiteral("body"), QStringLiteral("Some longer text, with a few words in it, like a notification body")},
+            {QStringLiteral("expireTimeout"), 5000},
+            {QStringLiteral("urgency"), seed % 3},
+        };
+    case Lists: {
+        QVariantList list;
+        list.reserve(8);
+        for (int i = 0; i < 8; ++i) {
+            list << seed + i;
+        }
+        return list;
+    }
+    }
+
+    return QVariant();
+}
+
+Plasma::DataEngine *LoadEngineLoader::internalLoadDataEngine(const QString &name)
+{
+    if (name == QLatin1String("load")) {
+        return new LoadEngine();
+    }
+    return nullptr;
+}
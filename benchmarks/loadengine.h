@@ -0,0 +1,99 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef LOADENGINE_H
+#define LOADENGINE_H
+
+#include <QTimer>
+
+#include "plasma/dataengine.h"
+#include "plasma/pluginloader.h"
+
+/**
+ * Synthetic data engine, generating configurable amounts of data to
+ * measure how the DataEngine, DataContainer, DataSource and DataModel
+ * pipeline copes with it.
+ *
+ * Sources are named "source0", "source1"... and their keys "key0", "key1"...
+ * Every update round gives a new value to every key of every source.
+ */
+class LoadEngine : public Plasma::DataEngine
+{
+    Q_OBJECT
+
+public:
+    enum Payload {
+        Numbers, /**< a double per key, like a system monitor sensor */
+        Strings, /**< a short string per key */
+        Maps, /**< a map per key, like a notification */
+        Lists, /**< a list of integers per key, like a history plot */
+    };
+
+    struct Profile {
+        int sources = 1;
+        int keysPerSource = 1;
+        Payload payload = Numbers;
+        // in milliseconds, used by start()
+        int updateInterval = 1000;
+    };
+
+    explicit LoadEngine(QObject *parent = nullptr);
+    ~LoadEngine() override;
+
+    /**
+     * Removes all the sources and creates the ones of profile
+     */
+    void setProfile(const Profile &profile);
+    Profile profile() const;
+
+    QStringList sourceNames() const;
+
+    /**
+     * Sets a new value to every key of every source
+     */
+    void updateRound();
+
+    /**
+     * Sets a new value to every key of source
+     */
+    void updateSource(int source);
+
+    /**
+     * Runs an update round every updateInterval milliseconds
+     */
+    void start();
+    void stop();
+
+    /**
+     * @return the number of values set since the profile was set
+     */
+    qint64 valuesSet() const;
+
+protected:
+    bool sourceRequestEvent(const QString &source) override;
+    bool updateSourceEvent(const QString &source) override;
+
+private:
+    QVariant value(int source, int key) const;
+
+    Profile m_profile;
+    QStringList m_sourceNames;
+    QStringList m_keys;
+    QHash<QString, int> m_sourceIndexes;
+    QTimer m_timer;
+    int m_round = 0;
+    qint64 m_valuesSet = 0;
+};
+
+/**
+ * Loads a LoadEngine for the data engine named "load"
+ */
+class LoadEngineLoader : public Plasma::PluginLoader
+{
+protected:
+    Plasma::DataEngine *internalLoadDataEngine(const QString &name) override;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "pluginloaderbenchmark.h"
+#include "benchmarkutils.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "plasma/pluginloader.h"
+
+// every instance has its own caches, unlike PluginLoader::self()
+class BenchmarkPluginLoader : public Plasma::PluginLoader
+{
+};
+
+static QString plasmoidsDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/plasma/plasmoids");
+}
+
+void PluginLoaderBenchmark::initTestCase()
+{
+    QDir(plasmoidsDir()).removeRecursively();
+
+    // a system with a lot of third party plasmoids, a few of them accepting drops
+    const QStringList mimeTypes = {QStringLiteral("text/plain"), QStringLiteral("image/png"), QStringLiteral("image/jpeg"),
+                                   QStringLiteral("text/uri-list"), QStringLiteral("application/pdf"), QStringLiteral("video/mp4")};
+    for (int i = 0; i < 400; ++i) {
+        const QString id = QStringLiteral("org.kde.benchmark.applet%1").arg(i);
+        const QString path = plasmoidsDir() + QLatin1Char('/') + id;
+        QVERIFY(QDir().mkpath(path + QStringLiteral("/contents/ui")));
+
+        QJsonObject metadata {
+            {QStringLiteral("KPackageStructure"), QStringLiteral("Plasma/Applet")},
+            {QStringLiteral("KPlugin"), QJsonObject {
+                {QStringLiteral("Id"), id},
+                {QStringLiteral("Name"), id},
+                {QStringLiteral("ServiceTypes"), QJsonArray {QStringLiteral("Plasma/Applet")}},
+            }},
+            {QStringLiteral("X-KDE-ParentApp"), QCoreApplication::applicationName()},
+        {QStringLiteral("X-Plasma-API"), QStringLiteral("declarativeappletscript")},
+            {QStringLiteral("X-Plasma-MainScript"), QStringLiteral("ui/main.qml")},
+        };
+        if (i % 10 == 0) {
+            metadata.insert(QStringLiteral("X-Plasma-DropMimeTypes"), QJsonArray {mimeTypes.at(i % mimeTypes.count())});
+        }
+        if (i % 20 == 0) {
+            metadata.insert(QStringLiteral("X-Plasma-DropUrlPatterns"), QJsonArray {
+                QStringLiteral("https://www%1.example.org/*").arg(i),
+                QStringLiteral("*.ext%1").arg(i),
+            });
+        }
+
+        QFile file(path + QStringLiteral("/metadata.json"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QJsonDocument(metadata).toJson());
+    }
+
+    // what a file dragged from a file manager offers
+    m_formats = {QStringLiteral("text/uri-list"), QStringLiteral("text/plain"), QStringLiteral("image/png"),
+                 QStringLiteral("application/x-kde4-urilist"), QStringLiteral("text/x-moz-url")};
+
+    if (Plasma::PluginLoader::self()->listAppletMetaDataForMimeType(QStringLiteral("image/png")).isEmpty()) {
+        QSKIP("The applet package structure is not installed");
+    }
+}
+
+void PluginLoaderBenchmark::cleanupTestCase()
+{
+    QDir(plasmoidsDir()).removeRecursively();
+}
+
+void PluginLoaderBenchmark::mimeTypeDropCold()
+{
+    // the first drop after startup or after a package got installed
+    QBENCHMARK {
+        BenchmarkPluginLoader loader;
+        for (const QString &format : qAsConst(m_formats)) {
+            loader.listAppletMetaDataForMimeType(format);
+        }
+    }
+}
+
+void PluginLoaderBenchmark::mimeTypeDropWarm()
+{
+    Plasma::PluginLoader *loader = Plasma::PluginLoader::self();
+
+    QBENCHMARK {
+        for (const QString &format : qAsConst(m_formats)) {
+            loader->listAppletMetaDataForMimeType(format);
+        }
+    }
+}
+
+void PluginLoaderBenchmark::urlDropWarm()
+{
+    Plasma::PluginLoader *loader = Plasma::PluginLoader::self();
+    const QUrl url(QStringLiteral("https://www200.example.org/some/page.html"));
+    QCOMPARE(loader->listAppletMetaDataForUrl(url).count(), 1);
+
+    QBENCHMARK {
+        loader->listAppletMetaDataForUrl(url);
+    }
+}
+
+PLASMA_BENCHMARK_MAIN(PluginLoaderBenchmark)
@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef PLUGINLOADERBENCHMARK_H
+#define PLUGINLOADERBENCHMARK_H
+
+#include <QTest>
+
+class PluginLoaderBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+private Q_SLOTS:
+    void mimeTypeDropCold();
+    void mimeTypeDropWarm();
+    void urlDropWarm();
+
+private:
+    QStringList m_formats;
+};
+
+#endif
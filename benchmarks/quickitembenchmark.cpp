@@ -0,0 +1,236 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "quickitembenchmark.h"
+#include "benchmarkutils.h"
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QIcon>
+#include <QQmlComponent>
+#include <QQmlEngine>
+#include <QQuickItem>
+#include <QSignalSpy>
+
+#include <KIconLoader>
+#include <KIconTheme>
+
+#include "plasma/theme.h"
+#include "plasmaquick/dialog.h"
+
+void QuickItemBenchmark::initTestCase()
+{
+    Plasma::BenchmarkUtils::clearCaches();
+    Plasma::TestUtils::installPlasmaTheme("breeze");
+    Plasma::Theme().setThemeName(QStringLiteral("default"));
+
+    QIcon::setThemeSearchPaths({QFINDTESTDATA("../autotests/data/icons")});
+    QIcon::setThemeName(QStringLiteral("test-theme"));
+    KIconTheme::forceThemeForTests(QStringLiteral("test-theme"));
+    KIconTheme::reconfigure();
+    KIconLoader::global()->reconfigure(QString());
+
+    m_view = new QQuickView();
+    m_view->setSource(QUrl::fromLocalFile(QFINDTESTDATA("../autotests/data/view.qml")));
+    m_view->resize(800, 600);
+    m_view->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_view));
+
+    if (!m_view->rootObject()) {
+        QSKIP("Cannot create the view.");
+    }
+}
+
+void QuickItemBenchmark::cleanupTestCase()
+{
+    delete m_view;
+}
+
+QQuickItem *QuickItemBenchmark::createItem(const QByteArray &qml)
+{
+    QQmlComponent component(m_view->engine());
+    component.setData(qml, QUrl());
+    QQuickItem *item = qobject_cast<QQuickItem *>(component.create(m_view->engine()->rootContext()));
+    if (item) {
+        item->setParentItem(m_view->rootObject());
+    }
+    return item;
+}
+
+void QuickItemBenchmark::renderFrame()
+{
+    // synchronizes the scene graph and renders, like a frame would
+    m_view->grabWindow();
+}
+
+void QuickItemBenchmark::iconItemTextures_data()
+{
+    QTest::addColumn<QString>("source");
+
+    QTest::newRow("plasma svg") << QStringLiteral("document-encrypt");
+    QTest::newRow("icon theme") << QStringLiteral("konversation");
+}
+
+void QuickItemBenchmark::iconItemTextures()
+{
+    QFETCH(QString, source);
+
+    const QByteArray qml = "import QtQuick 2.0\n"
+                           "import org.kde.plasma.core 2.0 as PlasmaCore\n"
+                           "Grid {\n"
+                           "    columns: 10\n"
+                           "    Repeater {\n"
+                           "        model: 50\n"
+                           "        PlasmaCore.IconItem { width: 32; height: 32; animated: false; source: \""
+                           + source.toUtf8()
+                           + "\" }\n"
+                             "    }\n"
+                             "}\n";
+
+    // creation, first texture upload and teardown of a typical icon grid
+    QBENCHMARK {
+        QQuickItem *grid = createItem(qml);
+        QVERIFY(grid);
+        renderFrame();
+        delete grid;
+    }
+}
+
+void QuickItemBenchmark::identicalSvgItems()
+{
+    const QByteArray qml =
+        "import QtQuick 2.0\n"
+        "import org.kde.plasma.core 2.0 as PlasmaCore\n"
+        "Grid {\n"
+        "    columns: 10\n"
+        "    PlasmaCore.Svg { id: arrows; imagePath: \"widgets/arrows\" }\n"
+        "    Repeater {\n"
+        "        model: 50\n"
+        "        PlasmaCore.SvgItem { width: 16; height: 16; svg: arrows; elementId: \"up-arrow\" }\n"
+        "    }\n"
+        "}\n";
+
+    // all the items end up on the same texture
+    QBENCHMARK {
+        QQuickItem *grid = createItem(qml);
+        QVERIFY(grid);
+        renderFrame();
+        delete grid;
+    }
+}
+
+void QuickItemBenchmark::frameSvgItemResize()
+{
+    QQuickItem *frame = createItem("import QtQuick 2.0\n"
+                                   "import org.kde.plasma.core 2.0 as PlasmaCore\n"
+                                   "PlasmaCore.FrameSvgItem { imagePath: \"widgets/background\"; width: 100; height: 100 }\n");
+    QVERIFY(frame);
+    renderFrame();
+
+    int step = 0;
+    QBENCHMARK {
+        frame->setSize(QSizeF(100 + (step % 32) * 7, 100 + (step % 32) * 3));
+        ++step;
+        renderFrame();
+    }
+
+    delete frame;
+}
+
+// the dialog shared by all the tooltips
+static PlasmaQuick::Dialog *toolTipDialog()
+{
+    const auto windows = QGuiApplication::topLevelWindows();
+    for (QWindow *window : windows) {
+        auto *dialog = qobject_cast<PlasmaQuick::Dialog *>(window);
+        if (dialog && dialog->type() == PlasmaQuick::Dialog::Tooltip) {
+            return dialog;
+        }
+    }
+    return nullptr;
+}
+
+void QuickItemBenchmark::toolTipShow()
+{
+    QQuickItem *area = createItem("import QtQuick 2.0\n"
+                                  "import org.kde.plasma.core 2.0 as PlasmaCore\n"
+                                  "PlasmaCore.ToolTipArea { width: 50; height: 50; mainText: \"Title\"; subText: \"Some longer description\" }\n");
+    QVERIFY(area);
+
+    // from the hover timer of the area firing to the dialog having
+    // presented its first frame, each time from a hidden dialog
+    const int shows = 20;
+    qint64 latency = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < shows; ++i) {
+        timer.start();
+        QMetaObject::invokeMethod(area, "showToolTip");
+        PlasmaQuick::Dialog *dialog = toolTipDialog();
+        QVERIFY(dialog);
+        QSignalSpy swapped(dialog, &QQuickWindow::frameSwapped);
+        QVERIFY(swapped.wait(5000));
+        latency += timer.nsecsElapsed();
+
+        QMetaObject::invokeMethod(area, "hideToolTip");
+        QTRY_VERIFY_WITH_TIMEOUT(!dialog->isVisible(), 5000);
+    }
+
+    QTest::setBenchmarkResult(qreal(latency) / shows, QTest::WalltimeNanoseconds);
+    delete area;
+}
+
+void QuickItemBenchmark::toolTipSweep()
+{
+    // a task manager sized row of tooltips, swept over with the mouse
+    QQuickItem *row = createItem("import QtQuick 2.0\n"
+                                 "import org.kde.plasma.core 2.0 as PlasmaCore\n"
+                                 "Row {\n"
+                                 "    Repeater {\n"
+                                 "        model: 40\n"
+                                 "        PlasmaCore.ToolTipArea { width: 20; height: 20; mainText: \"Task \" + index; subText: \"Window \" + index }\n"
+                                 "    }\n"
+                                 "}\n");
+    QVERIFY(row);
+
+    QVector<QQuickItem *> areas;
+    const auto children = row->childItems();
+    for (QQuickItem *child : children) {
+        if (child->inherits("ToolTip")) {
+            areas << child;
+        }
+    }
+    QCOMPARE(areas.count(), 40);
+
+    auto center = [](QQuickItem *item) {
+        return item->mapToScene(QPointF(item->width() / 2, item->height() / 2)).toPoint();
+    };
+
+    QTest::mouseMove(m_view, center(areas.first()));
+    QMetaObject::invokeMethod(areas.first(), "showToolTip");
+    PlasmaQuick::Dialog *dialog = toolTipDialog();
+    QVERIFY(dialog);
+    QTRY_VERIFY_WITH_TIMEOUT(dialog->isExposed(), 5000);
+
+    // from entering the next area to the dialog presenting its contents
+    qint64 latency = 0;
+    QElapsedTimer timer;
+    for (int i = 1; i < areas.count(); ++i) {
+        QSignalSpy swapped(dialog, &QQuickWindow::frameSwapped);
+        timer.start();
+        QTest::mouseMove(m_view, center(areas.at(i)));
+        QVERIFY(swapped.wait(5000));
+        latency += timer.nsecsElapsed();
+        QVERIFY(dialog->isVisible());
+    }
+
+    QTest::setBenchmarkResult(qreal(latency) / (areas.count() - 1), QTest::WalltimeNanoseconds);
+
+    QMetaObject::invokeMethod(areas.first(), "hideToolTip");
+    QTRY_VERIFY_WITH_TIMEOUT(!dialog->isVisible(), 5000);
+    delete row;
+}
+
+PLASMA_BENCHMARK_MAIN(QuickItemBenchmark)
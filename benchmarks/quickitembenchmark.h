@@ -0,0 +1,35 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef QUICKITEMBENCHMARK_H
+#define QUICKITEMBENCHMARK_H
+
+#include <QQuickView>
+#include <QTest>
+
+class QuickItemBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+private Q_SLOTS:
+    void iconItemTextures_data();
+    void iconItemTextures();
+    void identicalSvgItems();
+    void frameSvgItemResize();
+    void toolTipShow();
+    void toolTipSweep();
+
+private:
+    QQuickItem *createItem(const QByteArray &qml);
+    void renderFrame();
+
+    QQuickView *m_view = nullptr;
+};
+
+#endif
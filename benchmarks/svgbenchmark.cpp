@@ -0,0 +1,172 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "svgbenchmark.h"
+#include "benchmarkutils.h"
+
+#include <QDir>
+
+#include "plasma/theme.h"
+
+void SvgBenchmark::initTestCase()
+{
+    Plasma::BenchmarkUtils::clearCaches();
+    Plasma::TestUtils::installPlasmaTheme("breeze");
+    Plasma::Theme().setThemeName(QStringLiteral("default"));
+
+    m_arrows = {QStringLiteral("up-arrow"), QStringLiteral("down-arrow"),
+                QStringLiteral("left-arrow"), QStringLiteral("right-arrow")};
+
+    const QDir widgets(QStandardPaths::locate(QStandardPaths::GenericDataLocation,
+                                              QStringLiteral("plasma/desktoptheme/default/widgets"),
+                                              QStandardPaths::LocateDirectory));
+    const QStringList files = widgets.entryList({QStringLiteral("*.svgz")}, QDir::Files, QDir::Name);
+    for (const QString &file : files) {
+        m_widgets << QStringLiteral("widgets/") + file.chopped(5);
+    }
+    QVERIFY(!m_widgets.isEmpty());
+}
+
+void SvgBenchmark::loadAndRender()
+{
+    // the parsed svg is shared by all the Svg instances of the file,
+    // when the last one goes away the next load parses it again
+    QBENCHMARK {
+        Plasma::Svg svg;
+        svg.setImagePath(QStringLiteral("widgets/background"));
+        svg.setUsingRenderingCache(false);
+        svg.setContainsMultipleImages(true);
+        svg.resize(64, 64);
+        QVERIFY(!svg.pixmap(QStringLiteral("topleft")).isNull());
+    }
+}
+
+void SvgBenchmark::parseBreeze_data()
+{
+    QTest::addColumn<QList<int>>("colorGroups");
+
+    QTest::newRow("normal color group") << QList<int>{Plasma::Theme::NormalColorGroup};
+    QTest::newRow("all color groups") << QList<int>{Plasma::Theme::NormalColorGroup, Plasma::Theme::ButtonColorGroup,
+                                                    Plasma::Theme::ViewColorGroup, Plasma::Theme::ComplementaryColorGroup,
+                                                    Plasma::Theme::HeaderColorGroup, Plasma::Theme::ToolTipColorGroup};
+}
+
+void SvgBenchmark::parseBreeze()
+{
+    QFETCH(QList<int>, colorGroups);
+
+    // every widget of breeze in the given color groups: the files are read
+    // once, but the ones using the color scheme are parsed again for every
+    // stylesheet, so the difference between the rows is the cost of that
+    QBENCHMARK {
+        QVector<Plasma::Svg *> svgs;
+        for (const QString &widget : qAsConst(m_widgets)) {
+            for (int colorGroup : colorGroups) {
+                Plasma::Svg *svg = new Plasma::Svg;
+                svg->setImagePath(widget);
+                svg->setUsingRenderingCache(false);
+                svg->setColorGroup(static_cast<Plasma::Theme::ColorGroup>(colorGroup));
+                svg->resize(16, 16);
+                svg->pixmap();
+                svgs << svg;
+            }
+        }
+        qDeleteAll(svgs);
+    }
+}
+
+void SvgBenchmark::renderElementCold()
+{
+    Plasma::Svg svg;
+    svg.setImagePath(QStringLiteral("widgets/arrows"));
+    svg.setUsingRenderingCache(false);
+    svg.setContainsMultipleImages(true);
+    svg.resize(32, 32);
+
+    QBENCHMARK {
+        for (const QString &arrow : qAsConst(m_arrows)) {
+            svg.pixmap(arrow);
+        }
+    }
+}
+
+void SvgBenchmark::renderElementWarm()
+{
+    Plasma::Svg svg;
+    svg.setImagePath(QStringLiteral("widgets/arrows"));
+    svg.setContainsMultipleImages(true);
+    svg.resize(32, 32);
+
+    for (const QString &arrow : qAsConst(m_arrows)) {
+        QVERIFY(!svg.pixmap(arrow).isNull());
+    }
+
+    QBENCHMARK {
+        for (const QString &arrow : qAsConst(m_arrows)) {
+            svg.pixmap(arrow);
+        }
+    }
+}
+
+void SvgBenchmark::renderImageWarm()
+{
+    Plasma::Svg svg;
+    svg.setImagePath(QStringLiteral("widgets/arrows"));
+    svg.setContainsMultipleImages(true);
+
+    for (const QString &arrow : qAsConst(m_arrows)) {
+        QVERIFY(!svg.image(QSize(32, 32), arrow).isNull());
+    }
+
+    QBENCHMARK {
+        for (const QString &arrow : qAsConst(m_arrows)) {
+            svg.image(QSize(32, 32), arrow);
+        }
+    }
+}
+
+void SvgBenchmark::elementRect_data()
+{
+    QTest::addColumn<QString>("imagePath");
+    QTest::addColumn<QString>("elementId");
+
+    QTest::newRow("background") << QStringLiteral("widgets/background") << QStringLiteral("topleft");
+    QTest::newRow("panel-background") << QStringLiteral("widgets/panel-background") << QStringLiteral("shadow-hint-top-margin");
+    QTest::newRow("arrows") << QStringLiteral("widgets/arrows") << QStringLiteral("up-arrow");
+}
+
+void SvgBenchmark::elementRect()
+{
+    QFETCH(QString, imagePath);
+    QFETCH(QString, elementId);
+
+    Plasma::Svg svg;
+    svg.setImagePath(imagePath);
+    QVERIFY(svg.hasElement(elementId));
+
+    // lookups in the rects cache, as done many times per frame by FrameSvg
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            svg.elementRect(elementId);
+        }
+    }
+}
+
+void SvgBenchmark::hasMissingElement()
+{
+    Plasma::Svg svg;
+    svg.setImagePath(QStringLiteral("widgets/background"));
+    QVERIFY(!svg.hasElement(QStringLiteral("hint-compose-over-border")));
+
+    // the common case of probing optional hints
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            svg.hasElement(QStringLiteral("hint-compose-over-border"));
+        }
+    }
+}
+
+PLASMA_BENCHMARK_MAIN(SvgBenchmark)
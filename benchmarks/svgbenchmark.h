@@ -0,0 +1,36 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef SVGBENCHMARK_H
+#define SVGBENCHMARK_H
+
+#include <QTest>
+
+#include "plasma/svg.h"
+
+class SvgBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+
+private Q_SLOTS:
+    void loadAndRender();
+    void parseBreeze_data();
+    void parseBreeze();
+    void renderElementCold();
+    void renderElementWarm();
+    void renderImageWarm();
+    void elementRect_data();
+    void elementRect();
+    void hasMissingElement();
+
+private:
+    QStringList m_arrows;
+    QStringList m_widgets;
+};
+
+#endif
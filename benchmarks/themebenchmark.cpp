@@ -0,0 +1,95 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "themebenchmark.h"
+#include "benchmarkutils.h"
+
+void ThemeBenchmark::initTestCase()
+{
+    Plasma::BenchmarkUtils::clearCaches();
+    Plasma::TestUtils::installPlasmaTheme("breeze");
+
+    m_theme = new Plasma::Theme(this);
+    m_theme->setThemeName(QStringLiteral("default"));
+}
+
+void ThemeBenchmark::colors()
+{
+    QBENCHMARK {
+        for (int group = Plasma::Theme::NormalColorGroup; group <= Plasma::Theme::ToolTipColorGroup; ++group) {
+            for (int role = Plasma::Theme::TextColor; role <= Plasma::Theme::DisabledTextColor; ++role) {
+                m_theme->color(Plasma::Theme::ColorRole(role), Plasma::Theme::ColorGroup(group));
+            }
+        }
+    }
+}
+
+void ThemeBenchmark::styleSheet_data()
+{
+    QTest::addColumn<QString>("css");
+
+    QTest::newRow("default") << QString();
+    // what the colorizing of an svg goes through
+    QTest::newRow("svg") << QStringLiteral(
+        ".ColorScheme-Text { color:%textcolor; }\n"
+        ".ColorScheme-Background { color:%backgroundcolor; }\n"
+        ".ColorScheme-Highlight { color:%highlightcolor; }\n"
+        ".ColorScheme-HighlightedText { color:%highlightedtextcolor; }\n"
+        ".ColorScheme-PositiveText { color:%positivetextcolor; }\n"
+        ".ColorScheme-NeutralText { color:%neutraltextcolor; }\n"
+        ".ColorScheme-NegativeText { color:%negativetextcolor; }\n"
+        ".ColorScheme-ButtonText { color:%buttontextcolor; }\n"
+        ".ColorScheme-ButtonBackground { color:%buttonbackgroundcolor; }\n"
+        ".ColorScheme-ButtonHover { color:%buttonhovercolor; }\n"
+        ".ColorScheme-ButtonFocus { color:%buttonfocuscolor; }\n"
+        ".ColorScheme-ViewText { color:%viewtextcolor; }\n"
+        ".ColorScheme-ViewBackground { color:%viewbackgroundcolor; }\n"
+        ".ColorScheme-ViewHover { color:%viewhovercolor; }\n"
+        ".ColorScheme-ViewFocus { color:%viewfocuscolor; }\n"
+        ".ColorScheme-ComplementaryText { color:%complementarytextcolor; }\n"
+        ".ColorScheme-ComplementaryBackground { color:%complementarybackgroundcolor; }\n");
+    QTest::newRow("fonts") << QStringLiteral(
+        "body { font-family: %fontfamily; font-size: %fontsize; color: %textcolor; }\n"
+        "a { color: %link; } a:visited { color: %visitedlink; }\n"
+        "a:hover { color: %hoveredlink; } a:active { color: %activatedlink; }\n");
+}
+
+void ThemeBenchmark::styleSheet()
+{
+    QFETCH(QString, css);
+
+    QBENCHMARK {
+        m_theme->styleSheet(css);
+    }
+}
+
+void ThemeBenchmark::palette()
+{
+    QBENCHMARK {
+        m_theme->palette();
+    }
+}
+
+void ThemeBenchmark::imagePath_data()
+{
+    QTest::addColumn<QString>("name");
+
+    QTest::newRow("shipped") << QStringLiteral("widgets/background");
+    // optional images, that most themes don't have
+    QTest::newRow("missing") << QStringLiteral("widgets/does-not-exist");
+}
+
+void ThemeBenchmark::imagePath()
+{
+    QFETCH(QString, name);
+
+    QBENCHMARK {
+        m_theme->imagePath(name);
+        m_theme->currentThemeHasImage(name);
+    }
+}
+
+PLASMA_BENCHMARK_MAIN(ThemeBenchmark)
@@ -0,0 +1,32 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+#ifndef THEMEBENCHMARK_H
+#define THEMEBENCHMARK_H
+
+#include <QTest>
+
+#include "plasma/theme.h"
+
+class ThemeBenchmark : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void initTestCase();
+
+private Q_SLOTS:
+    void colors();
+    void styleSheet_data();
+    void styleSheet();
+    void palette();
+    void imagePath_data();
+    void imagePath();
+
+private:
+    Plasma::Theme *m_theme = nullptr;
+};
+
+#endif
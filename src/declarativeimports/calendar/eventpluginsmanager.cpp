@@ -10,14 +10,199 @@
 
 #include <QCoreApplication>
 #include <QAbstractListModel>
+#include <QDateTime>
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QPluginLoader>
+#include <QPointer>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
 #include <QDir>
 #include <QDebug>
 
+#include <functional>
+
 #include <KPluginLoader>
 #include <KPluginMetaData>
 
+// Process-wide catalog of the available calendar plugins. The metadata
+// is only gathered once, no matter how many calendars get instantiated,
+// and no plugin library is actually loaded until it gets enabled.
+class EventPluginsCatalog : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QMap<QString, EventPluginsManager::PluginData> PluginsMap;
+
+    static EventPluginsCatalog *self();
+
+    EventPluginsCatalog()
+    {
+        auto plugins = KPluginLoader::findPlugins(
+                QStringLiteral("plasmacalendarplugins"),
+                [](const KPluginMetaData &md) {
+                    return md.serviceTypes().contains(QLatin1String("PlasmaCalendar/Plugin"));
+                });
+        for (const KPluginMetaData &plugin : qAsConst(plugins)) {
+            m_plugins.insert(plugin.fileName(),
+                             { plugin.name(),
+                               plugin.description(),
+                               plugin.iconName(),
+                               plugin.value(QStringLiteral("X-KDE-PlasmaCalendar-ConfigUi"))
+                             });
+        }
+
+        // Fallback for legacy pre-KPlugin plugins so we can still load them;
+        // reading their metadata means opening every library in the plugin
+        // directories, so that happens off the GUI thread
+        QPointer<EventPluginsCatalog> guard(this);
+        const QStringList libraryPaths = QCoreApplication::libraryPaths();
+        const QStringList knownPlugins = m_plugins.keys();
+        QThreadPool::globalInstance()->start(new LegacyPluginsScanner(libraryPaths, knownPlugins, [guard](const PluginsMap &legacyPlugins) {
+            QCoreApplication *app = QCoreApplication::instance();
+            if (!app) {
+                return;
+            }
+            QMetaObject::invokeMethod(app, [guard, legacyPlugins]() {
+                if (guard) {
+                    guard->addLegacyPlugins(legacyPlugins);
+                }
+            }, Qt::QueuedConnection);
+        }));
+    }
+
+    PluginsMap plugins() const
+    {
+        return m_plugins;
+    }
+
+Q_SIGNALS:
+    void pluginsChanged();
+
+private:
+    class LegacyPluginsScanner : public QRunnable
+    {
+    public:
+        LegacyPluginsScanner(const QStringList &libraryPaths, const QStringList &knownPlugins,
+                             const std::function<void(const PluginsMap &)> &done)
+            : m_libraryPaths(libraryPaths),
+              m_knownPlugins(knownPlugins),
+              m_done(done)
+        {
+        }
+
+        void run() override
+        {
+            // The index remembers what every file in the plugin directories
+            // turned out to be, so unchanged libraries don't have to be opened
+            // again on the next start
+            const QString indexPath = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                                    + QLatin1String("/plasma-calendarplugins-index.json");
+            QFile indexFile(indexPath);
+            QJsonObject oldIndex;
+            if (indexFile.open(QIODevice::ReadOnly)) {
+                oldIndex = QJsonDocument::fromJson(indexFile.readAll()).object();
+                indexFile.close();
+            }
+            QJsonObject newIndex;
+
+            PluginsMap legacyPlugins;
+
+            for (const QString &libraryPath : qAsConst(m_libraryPaths)) {
+                const QString path(libraryPath + QStringLiteral("/plasmacalendarplugins"));
+                QDir dir(path);
+
+                if (!dir.exists()) {
+                    continue;
+                }
+
+                const QFileInfoList entryList = dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot);
+
+                for (const QFileInfo &fileInfo : entryList) {
+                    const QString absolutePath = fileInfo.absoluteFilePath();
+                    if (m_knownPlugins.contains(absolutePath) || legacyPlugins.contains(absolutePath)) {
+                        continue;
+                    }
+
+                    const qint64 mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+                    QJsonObject entry = oldIndex.value(absolutePath).toObject();
+
+                    if (entry.isEmpty() || entry.value(QStringLiteral("mtime")).toDouble() != mtime) {
+                        entry = QJsonObject();
+                        entry.insert(QStringLiteral("mtime"), double(mtime));
+
+                        QPluginLoader loader(absolutePath);
+                        // Load only our own plugins
+                        const bool isCalendarPlugin = loader.metaData().value(QStringLiteral("IID")) == QLatin1String("org.kde.CalendarEventsPlugin");
+                        entry.insert(QStringLiteral("calendarPlugin"), isCalendarPlugin);
+                        if (isCalendarPlugin) {
+                            entry.insert(QStringLiteral("MetaData"), loader.metaData().value(QStringLiteral("MetaData")).toObject());
+                        }
+                    }
+
+                    newIndex.insert(absolutePath, entry);
+
+                    if (entry.value(QStringLiteral("calendarPlugin")).toBool()) {
+                        const auto md = entry.value(QStringLiteral("MetaData")).toObject();
+                        legacyPlugins.insert(absolutePath,
+                                             { md.value(QStringLiteral("Name")).toString(),
+                                               md.value(QStringLiteral("Description")).toString(),
+                                               md.value(QStringLiteral("Icon")).toString(),
+                                               md.value(QStringLiteral("ConfigUi")).toString()
+                                             });
+                    }
+                }
+            }
+
+            if (newIndex != oldIndex) {
+                QDir().mkpath(QFileInfo(indexPath).absolutePath());
+                QSaveFile saveFile(indexPath);
+                if (saveFile.open(QIODevice::WriteOnly)) {
+                    saveFile.write(QJsonDocument(newIndex).toJson(QJsonDocument::Compact));
+                    saveFile.commit();
+                }
+            }
+
+            m_done(legacyPlugins);
+        }
+
+    private:
+        const QStringList m_libraryPaths;
+        const QStringList m_knownPlugins;
+        const std::function<void(const PluginsMap &)> m_done;
+    };
+
+    void addLegacyPlugins(const PluginsMap &legacyPlugins)
+    {
+        if (legacyPlugins.isEmpty()) {
+            return;
+        }
+
+        for (auto it = legacyPlugins.constBegin(); it != legacyPlugins.constEnd(); ++it) {
+            m_plugins.insert(it.key(), it.value());
+        }
+
+        Q_EMIT pluginsChanged();
+    }
+
+    PluginsMap m_plugins;
+};
+
+class EventPluginsCatalogSingleton
+{
+public:
+    EventPluginsCatalog self;
+};
+
+Q_GLOBAL_STATIC(EventPluginsCatalogSingleton, privateEventPluginsCatalogSelf)
+
+EventPluginsCatalog *EventPluginsCatalog::self()
+{
+    return &privateEventPluginsCatalogSelf()->self;
+}
+
 class EventPluginsModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -123,53 +308,19 @@ private:
 EventPluginsManager::EventPluginsManager(QObject *parent)
     : QObject(parent)
 {
-    auto plugins = KPluginLoader::findPlugins(
-            QStringLiteral("plasmacalendarplugins"),
-            [](const KPluginMetaData &md) {
-                return md.serviceTypes().contains(QLatin1String("PlasmaCalendar/Plugin"));
-            });
-    for (const KPluginMetaData &plugin : qAsConst(plugins)) {
-        m_availablePlugins.insert(plugin.fileName(),
-                                  { plugin.name(),
-                                    plugin.description(),
-                                    plugin.iconName(),
-                                    plugin.value(QStringLiteral("X-KDE-PlasmaCalendar-ConfigUi"))
-                                  });
-    }
-
-    // Fallback for legacy pre-KPlugin plugins so we can still load them
-    const QStringList paths = QCoreApplication::libraryPaths();
-    for (const QString &libraryPath : paths) {
-        const QString path(libraryPath + QStringLiteral("/plasmacalendarplugins"));
-        QDir dir(path);
-
-        if (!dir.exists()) {
-            continue;
-        }
-
-        const QStringList entryList = dir.entryList(QDir::Files | QDir::NoDotAndDotDot);
-
-        for (const QString &fileName : entryList) {
-            const QString absolutePath = dir.absoluteFilePath(fileName);
-            if (m_availablePlugins.contains(absolutePath)) {
-                continue;
-            }
-
-            QPluginLoader loader(absolutePath);
-            // Load only our own plugins
-            if (loader.metaData().value(QStringLiteral("IID")) == QLatin1String("org.kde.CalendarEventsPlugin")) {
-                const auto md = loader.metaData().value(QStringLiteral("MetaData")).toObject();
-                m_availablePlugins.insert(absolutePath,
-                                          { md.value(QStringLiteral("Name")).toString(),
-                                            md.value(QStringLiteral("Description")).toString(),
-                                            md.value(QStringLiteral("Icon")).toString(),
-                                            md.value(QStringLiteral("ConfigUi")).toString()
-                                          });
-            }
-        }
-    }
+    EventPluginsCatalog *catalog = EventPluginsCatalog::self();
+    m_availablePlugins = catalog->plugins();
 
     m_model = new EventPluginsModel(this);
+
+    // The legacy plugins are discovered asynchronously, pick them
+    // up once the catalog has finished scanning the library paths
+    connect(catalog, &EventPluginsCatalog::pluginsChanged, this, [this]() {
+        m_model->beginResetModel();
+        m_availablePlugins = EventPluginsCatalog::self()->plugins();
+        m_model->endResetModel();
+        Q_EMIT pluginsChanged();
+    });
 }
 
 EventPluginsManager::~EventPluginsManager()
@@ -54,6 +54,7 @@ private:
     void loadPlugin(const QString &absolutePath);
 
     friend class EventPluginsModel;
+    friend class EventPluginsCatalog;
     EventPluginsModel *m_model = nullptr;
     QList<CalendarEvents::CalendarEventsPlugin*> m_plugins;
     struct PluginData {
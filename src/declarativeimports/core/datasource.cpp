@@ -35,12 +35,16 @@ void DataSource::componentComplete()
 
 void DataSource::setConnectedSources(const QStringList &sources)
 {
+    // diff the two lists through sets, they can hold thousands of sources
+    // when connecting to every process or every device
+    const QSet<QString> newSources(sources.cbegin(), sources.cend());
     bool sourcesChanged = false;
+
     for (const QString &source : sources) {
-        if (!m_connectedSources.contains(source)) {
+        if (!m_connectedSourcesSet.contains(source)) {
             sourcesChanged = true;
             if (m_dataEngine) {
-                m_connectedSources.append(source);
+                m_connectedSourcesSet.insert(source);
                 m_dataEngine->connectSource(source, this, m_interval, m_intervalAlignment);
                 Q_EMIT sourceConnected(source);
             }
@@ -48,7 +52,7 @@ void DataSource::setConnectedSources(const QStringList &sources)
     }
 
     for (const QString &source : qAsConst(m_connectedSources)) {
-        if (!sources.contains(source)) {
+        if (!newSources.contains(source)) {
             m_data->clear(source);
             sourcesChanged = true;
             if (m_dataEngine) {
@@ -60,6 +64,11 @@ void DataSource::setConnectedSources(const QStringList &sources)
 
     if (sourcesChanged) {
         m_connectedSources = sources;
+        // keep a single entry per source, as the set does
+        if (m_connectedSources.size() != newSources.size()) {
+            m_connectedSources.removeDuplicates();
+        }
+        m_connectedSourcesSet = newSources;
         Q_EMIT connectedSourcesChanged();
     }
 }
@@ -122,7 +131,7 @@ void DataSource::setInterval(const int interval)
     }
 
     m_interval = interval;
-    setupData();
+    retimeSources();
     Q_EMIT intervalChanged();
 }
 
@@ -133,7 +142,7 @@ void DataSource::setIntervalAlignment(Plasma::Types::IntervalAlignment intervalA
     }
 
     m_intervalAlignment = intervalAlignment;
-    setupData();
+    retimeSources();
     Q_EMIT intervalAlignmentChanged();
 }
 
@@ -154,10 +163,25 @@ void DataSource::setupData()
     }
 }
 
+void DataSource::retimeSources()
+{
+    if (!m_ready || !m_dataEngine) {
+        return;
+    }
+
+    // connecting an already connected source only moves it to a relay
+    // with the new interval, the sources and their services stay as they are.
+    // sourceConnected is still emitted, as it always was on an interval change
+    for (const QString &source : qAsConst(m_connectedSources)) {
+        m_dataEngine->connectSource(source, this, m_interval, m_intervalAlignment);
+        Q_EMIT sourceConnected(source);
+    }
+}
+
 void DataSource::dataUpdated(const QString &sourceName, const Plasma::DataEngine::Data &data)
 {
     //it can arrive also data we don't explicitly connected a source
-    if (m_connectedSources.contains(sourceName)) {
+    if (m_connectedSourcesSet.contains(sourceName)) {
         m_data->insert(sourceName, data);
         Q_EMIT dataChanged();
         Q_EMIT newData(sourceName, data);
@@ -186,8 +210,9 @@ void DataSource::removeSource(const QString &source)
     m_models->clear(source);
 
     //TODO: emit those signals as last thing
-    if (m_connectedSources.contains(source)) {
-        m_connectedSources.removeAll(source);
+    if (m_connectedSourcesSet.remove(source)) {
+        // the set guarantees a single entry, stop at the first match
+        m_connectedSources.removeOne(source);
         Q_EMIT sourceDisconnected(source);
         Q_EMIT connectedSourcesChanged();
     }
@@ -216,11 +241,12 @@ QObject *DataSource::serviceForSource(const QString &source)
 
 void DataSource::connectSource(const QString &source)
 {
-    if (m_connectedSources.contains(source)) {
+    if (m_connectedSourcesSet.contains(source)) {
         return;
     }
 
     m_connectedSources.append(source);
+    m_connectedSourcesSet.insert(source);
     if (m_dataEngine) {
         m_dataEngine->connectSource(source, this, m_interval, m_intervalAlignment);
         Q_EMIT sourceConnected(source);
@@ -230,8 +256,8 @@ void DataSource::connectSource(const QString &source)
 
 void DataSource::disconnectSource(const QString &source)
 {
-    if (m_dataEngine && m_connectedSources.contains(source)) {
-        m_connectedSources.removeAll(source);
+    if (m_dataEngine && m_connectedSourcesSet.remove(source)) {
+        m_connectedSources.removeOne(source);
         m_dataEngine->disconnectSource(source, this);
         Q_EMIT sourceDisconnected(source);
         Q_EMIT connectedSourcesChanged();
@@ -12,6 +12,7 @@
 
 #include <QObject>
 #include <QScopedPointer>
+#include <QSet>
 #include <QtQml>
 #include <QQmlPropertyMap>
 #include <QQmlParserStatus>
@@ -152,6 +153,7 @@ public Q_SLOTS:
 protected Q_SLOTS:
     void removeSource(const QString &source);
     void setupData();
+    void retimeSources();
     void updateSources();
 
 Q_SIGNALS:
@@ -179,6 +181,8 @@ private:
     QScopedPointer<Plasma::DataEngineConsumer> m_dataEngineConsumer;
     QStringList m_sources;
     QStringList m_connectedSources;
+    // same content as m_connectedSources, for the lookups
+    QSet<QString> m_connectedSourcesSet;
     QStringList m_oldSources;
     QStringList m_newSources;
     Changes m_changes;
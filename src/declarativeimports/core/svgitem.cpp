@@ -11,6 +11,7 @@
 #include <QSGTexture>
 #include <QRectF>
 #include <QDebug>
+#include <QMutex>
 
 #include "plasma/svg.h"
 
@@ -21,6 +22,85 @@
 namespace Plasma
 {
 
+// Identical renderings of the same svg element, like the arrows of every
+// row in a list, get the same texture instead of uploading one copy each.
+// Svg::image() hands out the same QImage for the same rendering, so its
+// cacheKey() identifies the rendering: when the svg gets rendered again,
+// for instance after a color scheme change, the new image has a new key.
+class SvgTextureRegistry
+{
+public:
+    QSharedPointer<QSGTexture> texture(QQuickWindow *window, const QImage &image);
+
+    SvgItem::TextureStatistics statistics()
+    {
+        QMutexLocker lock(&m_mutex);
+        return m_statistics;
+    }
+
+    // textures are released from the render thread when their nodes go away
+    void release(QQuickWindow *window, qint64 key, QSGTexture *texture)
+    {
+        QMutexLocker lock(&m_mutex);
+
+        --m_statistics.texturesAlive;
+
+        auto windowIt = m_textures.find(window);
+        if (windowIt == m_textures.end()) {
+            return;
+        }
+        auto it = windowIt->find(key);
+        // the entry may already point to a newer texture for the same key
+        if (it != windowIt->end() && it->rawTexture == texture) {
+            windowIt->erase(it);
+        }
+        if (windowIt->isEmpty()) {
+            m_textures.erase(windowIt);
+        }
+    }
+
+private:
+    struct Entry {
+        QWeakPointer<QSGTexture> texture;
+        QSGTexture *rawTexture;
+    };
+
+    QMutex m_mutex;
+    // keyed by the cacheKey() of the images
+    QHash<QQuickWindow *, QHash<qint64, Entry>> m_textures;
+    SvgItem::TextureStatistics m_statistics;
+};
+
+Q_GLOBAL_STATIC(SvgTextureRegistry, s_textureRegistry)
+
+QSharedPointer<QSGTexture> SvgTextureRegistry::texture(QQuickWindow *window, const QImage &image)
+{
+    QMutexLocker lock(&m_mutex);
+
+    const qint64 key = image.cacheKey();
+    auto &textures = m_textures[window];
+    auto it = textures.find(key);
+    if (it != textures.end()) {
+        if (QSharedPointer<QSGTexture> texture = it->texture.toStrongRef()) {
+            ++m_statistics.textureReuses;
+            return texture;
+        }
+    }
+
+    QSharedPointer<QSGTexture> texture(window->createTextureFromImage(image, QQuickWindow::TextureCanUseAtlas),
+        [window, key](QSGTexture *texture) {
+            if (!s_textureRegistry.isDestroyed()) {
+                s_textureRegistry->release(window, key, texture);
+            }
+            delete texture;
+        });
+    textures[key] = Entry{texture.toWeakRef(), texture.data()};
+
+    ++m_statistics.texturesAlive;
+    m_statistics.bytesUploaded += image.sizeInBytes();
+    return texture;
+}
+
 SvgItem::SvgItem(QQuickItem *parent)
     : QQuickItem(parent),
       m_textureChanged(false)
@@ -134,8 +214,7 @@ QSGNode *SvgItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *updateP
             return nullptr;
         }
 
-        QSharedPointer<QSGTexture> texture(window()->createTextureFromImage(m_image, QQuickWindow::TextureCanUseAtlas));
-        textureNode->setTexture(texture);
+        textureNode->setTexture(s_textureRegistry->texture(window(), m_image));
         m_textureChanged = false;
 
         textureNode->setRect(0, 0, width(), height());
@@ -146,6 +225,11 @@ QSGNode *SvgItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *updateP
     return textureNode;
 }
 
+SvgItem::TextureStatistics SvgItem::textureStatistics()
+{
+    return s_textureRegistry->statistics();
+}
+
 void SvgItem::updateNeeded()
 {
     if (implicitWidth() <= 0) {
@@ -62,6 +62,16 @@ public:
     QSizeF naturalSize() const;
 
     QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *updatePaintNodeData) override;
+
+    struct TextureStatistics {
+        // textures currently used by at least one item
+        int texturesAlive = 0;
+        // times an item got a texture already uploaded for another one
+        quint64 textureReuses = 0;
+        quint64 bytesUploaded = 0;
+    };
+    // counters of the textures shared by all the SvgItems of the process
+    static TextureStatistics textureStatistics();
 /// @endcond
 
 Q_SIGNALS:
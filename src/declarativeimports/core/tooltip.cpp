@@ -9,6 +9,7 @@
 #include "tooltip.h"
 #include "tooltipdialog.h"
 
+#include <QCoreApplication>
 #include <QQmlEngine>
 #include <QDebug>
 
@@ -18,6 +19,11 @@
 
 ToolTipDialog *ToolTip::s_dialog = nullptr;
 int ToolTip::s_dialogUsers  = 0;
+static const int s_dialogReleaseDelay = 30000;
+// restarted by the last tooltip to stop using the dialog, child of the dialog
+static QTimer *s_dialogReleaseTimer = nullptr;
+// no more tooltips are going to be shown, nor deferred deletes to run
+static bool s_quitting = false;
 
 ToolTip::ToolTip(QQuickItem *parent)
     : QQuickItem(parent),
@@ -53,11 +59,19 @@ ToolTip::~ToolTip()
 
     if (m_usingDialog) {
         --s_dialogUsers;
-    }
 
-    if (s_dialogUsers == 0) {
-        delete s_dialog;
-        s_dialog = nullptr;
+        if (s_dialogUsers == 0 && s_dialog) {
+            if (s_quitting || QCoreApplication::closingDown()) {
+                delete s_dialog;
+                s_dialog = nullptr;
+                s_dialogReleaseTimer = nullptr;
+            } else {
+                // Keep the dialog and its default delegate warm for a while: tooltip
+                // owners tend to be destroyed and recreated in bulk, for instance when
+                // a task manager or a panel gets repopulated
+                s_dialogReleaseTimer->start();
+            }
+        }
     }
 }
 
@@ -87,12 +101,37 @@ ToolTipDialog *ToolTip::tooltipDialogInstance()
 {
     if (!s_dialog) {
         s_dialog = new ToolTipDialog;
-        s_dialogUsers = 1;
+
+        s_dialogReleaseTimer = new QTimer(s_dialog);
+        s_dialogReleaseTimer->setSingleShot(true);
+        s_dialogReleaseTimer->setInterval(s_dialogReleaseDelay);
+        QObject::connect(s_dialogReleaseTimer, &QTimer::timeout, s_dialog, []() {
+            if (s_dialogUsers == 0) {
+                s_dialog->deleteLater();
+                s_dialog = nullptr;
+                s_dialogReleaseTimer = nullptr;
+            }
+        });
+
+        // don't leave the dialog behind on exit
+        static bool s_watchingQuit = false;
+        if (!s_watchingQuit && QCoreApplication::instance()) {
+            s_watchingQuit = true;
+            QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, []() {
+                s_quitting = true;
+                if (s_dialog && s_dialogUsers == 0) {
+                    delete s_dialog;
+                    s_dialog = nullptr;
+                    s_dialogReleaseTimer = nullptr;
+                }
+            });
+        }
     }
 
     if (!m_usingDialog) {
         s_dialogUsers++;
         m_usingDialog = true;
+        s_dialogReleaseTimer->stop();
     }
 
     return s_dialog;
@@ -121,13 +160,13 @@ void ToolTip::showToolTip()
 
     ToolTipDialog *dlg = tooltipDialogInstance();
 
+    // Nothing gets instantiated per show: a custom mainItem is created once
+    // by the owner's QML and only reparented into the dialog, the default
+    // delegate is created once per dialog and rebound via its toolTip property
     if (!mainItem()) {
         setMainItem(dlg->loadDefaultItem());
     }
 
-    // Unset the dialog's old contents before reparenting the dialog.
-    dlg->setMainItem(nullptr);
-
     Plasma::Types::Location location = m_location;
     if (m_location == Plasma::Types::Floating) {
         QQuickItem *p = parentItem();
@@ -147,9 +186,19 @@ void ToolTip::showToolTip()
 
     dlg->setHideTimeout(m_timeout);
     dlg->setOwner(this);
-    dlg->setLocation(location);
-    dlg->setVisualParent(this);
-    dlg->setMainItem(mainItem());
+
+    // Sweeping over items sharing the default delegate only changes the
+    // visual parent: keep the current contents in place in that case, so
+    // the geometry gets computed only once for this show
+    if (dlg->mainItem() && dlg->mainItem() == mainItem() && dlg->location() == location) {
+        dlg->setVisualParent(this);
+    } else {
+        // Unset the dialog's old contents before reparenting the dialog.
+        dlg->setMainItem(nullptr);
+        dlg->setLocation(location);
+        dlg->setVisualParent(this);
+        dlg->setMainItem(mainItem());
+    }
     dlg->setInteractive(m_interactive);
     dlg->setVisible(true);
 }
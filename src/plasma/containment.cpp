@@ -140,15 +140,6 @@ void Containment::init()
     });
 }
 
-// helper function for sorting the list of applets
-bool appletConfigLessThan(const KConfigGroup &c1, const KConfigGroup &c2)
-{
-    int i1 = c1.readEntry("id", 0);
-    int i2 = c2.readEntry("id", 0);
-
-    return (i1 < i2);
-}
-
 void Containment::restore(KConfigGroup &group)
 {
     /*
@@ -257,32 +248,13 @@ void Containment::restoreContents(KConfigGroup &group)
 {
     KConfigGroup applets(&group, "Applets");
 
-    //restore the applets ordered by id
-    QStringList groups = applets.groupList();
-    std::sort(groups.begin(), groups.end());
-
-    // Sort the applet configs in order of geometry to ensure that applets
-    // are added from left to right or top to bottom for a panel containment
-    QList<KConfigGroup> appletConfigs;
-    for (const QString &appletGroup : qAsConst(groups)) {
-        //qCDebug(LOG_PLASMA) << "reading from applet group" << appletGroup;
-        KConfigGroup appletConfig(&applets, appletGroup);
-        appletConfigs.append(appletConfig);
-    }
-    std::stable_sort(appletConfigs.begin(), appletConfigs.end(), appletConfigLessThan);
-
-    QMutableListIterator<KConfigGroup> it(appletConfigs);
-    while (it.hasNext()) {
-        KConfigGroup &appletConfig = it.next();
-        int appId = appletConfig.name().toUInt();
-        QString plugin = appletConfig.readEntry("plugin", QString());
-
-        if (plugin.isEmpty()) {
-            continue;
-        }
-
-        d->createApplet(plugin, QVariantList(), appId);
+    // the configuration of each applet is only looked at once it's created
+    const auto layoutApplets = ContainmentPrivate::layoutApplets(applets);
+    for (const ContainmentPrivate::LayoutApplet &layoutApplet : layoutApplets) {
+        d->restoringAppletId = layoutApplet.id;
+        d->createApplet(layoutApplet.plugin, QVariantList(), layoutApplet.id);
     }
+    d->restoringAppletId = 0;
 
     //if there are no applets, none of them is "loading"
     if (Containment::applets().isEmpty()) {
@@ -453,7 +425,8 @@ void Containment::addApplet(Applet *applet)
     connect(this, &Containment::containmentDisplayHintsChanged, applet, &Applet::containmentDisplayHintsChanged);
 
     if (!currentContainment) {
-        const bool isNew = applet->d->mainConfigGroup()->entryMap().isEmpty();
+        // an applet of the layout being restored has its configuration already
+        const bool isNew = applet->id() != d->restoringAppletId && applet->d->mainConfigGroup()->keyList().isEmpty();
 
         if (!isNew) {
             applet->restore(*applet->d->mainConfigGroup());
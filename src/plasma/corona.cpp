@@ -12,10 +12,12 @@
 
 #include <QGuiApplication>
 #include <QMimeData>
+#include <QSet>
 #include <QPainter>
 #include <QTimer>
 #include <QScreen>
 
+#include <algorithm>
 #include <cmath>
 
 #include <QDebug>
@@ -159,6 +161,8 @@ void Corona::loadLayout(const QString &configName)
         // if we have a new config name passed in, then use that as the config file for this Corona
         d->config = nullptr;
         d->configName = configName;
+        // they were in the previous one
+        d->deferredContainments.clear();
     }
 
     KConfigGroup conf(config(), QString());
@@ -203,6 +207,10 @@ Containment *Corona::containmentForScreen(int screen,
 {
     Containment *containment = nullptr;
 
+    d->loadDeferredContainments([screen, &activity](const CoronaPrivate::DeferredContainment &deferred) {
+        return deferred.lastScreen == screen && (deferred.activityId.isEmpty() || deferred.activityId == activity);
+    });
+
     for (Containment *cont : qAsConst(d->containments)) {
         if (cont->lastScreen() == screen &&
             (cont->activity().isEmpty() || cont->activity() == activity) &&
@@ -237,6 +245,10 @@ QList<Containment *> Corona::containmentsForActivity(const QString &activity)
         return conts;
     }
 
+    d->loadDeferredContainments([&activity](const CoronaPrivate::DeferredContainment &deferred) {
+        return deferred.activityId == activity;
+    });
+
     std::copy_if(d->containments.begin(),
                  d->containments.end(),
                  std::back_inserter(conts),
@@ -255,6 +267,10 @@ QList<Containment *> Corona::containmentsForScreen(int screen)
         return conts;
     }
 
+    d->loadDeferredContainments([screen](const CoronaPrivate::DeferredContainment &deferred) {
+        return deferred.lastScreen == screen;
+    });
+
     std::copy_if(d->containments.begin(),
                  d->containments.end(),
                  std::back_inserter(conts),
@@ -265,6 +281,49 @@ QList<Containment *> Corona::containmentsForScreen(int screen)
     return conts;
 }
 
+void Corona::setDeferredLoadingEnabled(bool enabled)
+{
+    d->deferredLoading = enabled;
+    if (!enabled) {
+        d->loadDeferredContainments([](const CoronaPrivate::DeferredContainment &) {
+            return true;
+        });
+    }
+}
+
+bool Corona::isDeferredLoadingEnabled() const
+{
+    return d->deferredLoading;
+}
+
+void Corona::setRunningActivities(const QStringList &activities)
+{
+    d->runningActivities = activities;
+    d->loadDeferredContainments([this](const CoronaPrivate::DeferredContainment &deferred) {
+        return !d->isDeferred(deferred);
+    });
+}
+
+QStringList Corona::runningActivities() const
+{
+    return d->runningActivities;
+}
+
+int Corona::deferredContainmentsCount() const
+{
+    return d->deferredContainments.count();
+}
+
+quint64 Corona::constraintsFlushCount() const
+{
+    return d->constraintsFlushes;
+}
+
+quint64 Corona::constraintsEventCount() const
+{
+    return d->constraintsEvents;
+}
+
 QList<Containment *> Corona::containments() const
 {
     return d->containments;
@@ -322,6 +381,43 @@ QRect Corona::availableScreenRect(int id) const
     return screenGeometry(id);
 }
 
+QRegion Corona::cachedAvailableScreenRegion(int id) const
+{
+    return d->availableRegion(id).region;
+}
+
+bool Corona::availableScreenRegionContains(int id, const QRect &rect) const
+{
+    if (rect.isEmpty()) {
+        return false;
+    }
+
+    const QVector<QRect> &rects = d->availableRegion(id).rects;
+
+    // the rects don't overlap, so rect is inside the region when
+    // the parts of it they cover add up to its whole area
+    const qint64 area = qint64(rect.width()) * rect.height();
+    qint64 covered = 0;
+
+    // skip the bands ending above rect
+    auto it = std::lower_bound(rects.cbegin(), rects.cend(), rect.top(), [](const QRect &r, int top) {
+        return r.top() < top;
+    });
+    // a band starting above rect.top() may still reach into it
+    while (it != rects.cbegin() && (it - 1)->bottom() >= rect.top()) {
+        --it;
+    }
+
+    for (; it != rects.cend() && it->top() <= rect.bottom(); ++it) {
+        const QRect part = it->intersected(rect);
+        if (!part.isEmpty()) {
+            covered += qint64(part.width()) * part.height();
+        }
+    }
+
+    return covered == area;
+}
+
 void Corona::loadDefaultLayout()
 {
     //Default implementation does nothing
@@ -446,7 +542,8 @@ CoronaPrivate::CoronaPrivate(Corona *corona)
       config(nullptr),
       configSyncTimer(new QTimer(corona)),
       actions(corona),
-      containmentsStarting(0)
+      containmentsStarting(0),
+      constraintsFlushTimer(new QTimer(corona))
 {
     //TODO: make Package path configurable
 
@@ -464,11 +561,40 @@ CoronaPrivate::~CoronaPrivate()
 
 void CoronaPrivate::init()
 {
+    QObject::connect(q, &Corona::availableScreenRegionChanged, q, [this]() {
+        invalidateAvailableRegions();
+    });
+    QObject::connect(q, &Corona::availableScreenRectChanged, q, [this]() {
+        invalidateAvailableRegions();
+    });
+    QObject::connect(q, &Corona::screenGeometryChanged, q, [this]() {
+        invalidateAvailableRegions();
+    });
+    // screens coming and going don't necessarily come with a region change
+    QObject::connect(q, &Corona::screenAdded, q, [this]() {
+        invalidateAvailableRegions();
+    });
+    QObject::connect(q, &Corona::screenRemoved, q, [this]() {
+        invalidateAvailableRegions();
+    });
+    // connected before any subclass, so the containments of the screen are there for it
+    QObject::connect(q, &Corona::screenAdded, q, [this](int id) {
+        loadDeferredContainments([this, id](const DeferredContainment &deferred) {
+            return deferred.lastScreen == id && !isDeferred(deferred);
+        });
+    });
+
     desktopDefaultsConfig = KConfigGroup(KSharedConfig::openConfig(package.filePath("defaults")), "Desktop");
 
     configSyncTimer->setSingleShot(true);
     QObject::connect(configSyncTimer, SIGNAL(timeout()), q, SLOT(syncConfig()));
 
+    constraintsFlushTimer->setSingleShot(true);
+    constraintsFlushTimer->setInterval(0);
+    QObject::connect(constraintsFlushTimer, &QTimer::timeout, q, [this]() {
+        flushPendingConstraints();
+    });
+
     //some common actions
     actions.setConfigGroup(QStringLiteral("Shortcuts"));
 
@@ -497,6 +623,33 @@ void CoronaPrivate::init()
     editAction->setShortcutContext(Qt::ApplicationShortcut);
 }
 
+const CoronaPrivate::AvailableRegion &CoronaPrivate::availableRegion(int id)
+{
+    AvailableRegion &cached = availableRegions[id];
+    if (cached.version == availableRegionsVersion) {
+        return cached;
+    }
+
+    cached.version = availableRegionsVersion;
+    cached.region = q->availableScreenRegion(id);
+    cached.rects.clear();
+    cached.rects.reserve(cached.region.rectCount());
+    for (const QRect &rect : cached.region) {
+        cached.rects.append(rect);
+    }
+    // QRegion already stores its rects in bands from top to bottom, this only makes it explicit
+    std::sort(cached.rects.begin(), cached.rects.end(), [](const QRect &a, const QRect &b) {
+        return a.top() < b.top() || (a.top() == b.top() && a.left() < b.left());
+    });
+
+    return cached;
+}
+
+void CoronaPrivate::invalidateAvailableRegions()
+{
+    ++availableRegionsVersion;
+}
+
 void CoronaPrivate::toggleImmutability()
 {
     if (immutability == Types::Mutable) {
@@ -514,6 +667,15 @@ void CoronaPrivate::saveLayout(KSharedConfigPtr cg) const
         KConfigGroup containmentConfig(&containmentsGroup, cid);
         containment->save(containmentConfig);
     }
+
+    // the deferred containments only have their configuration
+    if (cg != q->config()) {
+        const KConfigGroup layoutContainments(q->config(), "Containments");
+        for (auto it = deferredContainments.constBegin(); it != deferredContainments.constEnd(); ++it) {
+            KConfigGroup containmentConfig(&containmentsGroup, QString::number(it.key()));
+            KConfigGroup(&layoutContainments, QString::number(it.key())).copyTo(&containmentConfig);
+        }
+    }
 }
 
 void CoronaPrivate::updateContainmentImmutability()
@@ -652,7 +814,7 @@ QList<Plasma::Containment *> CoronaPrivate::importLayout(const KConfigGroup &con
     for (const QString &group : qAsConst(groups)) {
         KConfigGroup containmentConfig(&containmentsGroup, group);
 
-        if (containmentConfig.entryMap().isEmpty()) {
+        if (containmentConfig.keyList().isEmpty()) {
             continue;
         }
 
@@ -671,11 +833,32 @@ QList<Plasma::Containment *> CoronaPrivate::importLayout(const KConfigGroup &con
             containmentConfig.copyTo(&realConf);
         }
 
+        const QString plugin = containmentConfig.readEntry("plugin", QString());
+
+        // importing a layout into a running session always creates its containments
+        if (!mergeConfig) {
+            const DeferredContainment deferred{plugin, containmentConfig.readEntry("activityId", QString()), containmentConfig.readEntry("lastScreen", -1)};
+            if (isDeferred(deferred)) {
+                // its applets get their ids only once it's loaded: until then
+                // nothing else can be given them
+                const QStringList appletGroups = KConfigGroup(&containmentConfig, "Applets").groupList();
+                for (const QString &appletGroup : appletGroups) {
+                    const uint appletId = appletGroup.toUInt();
+                    if (appletId > AppletPrivate::s_maxAppletId) {
+                        AppletPrivate::s_maxAppletId = appletId;
+                    }
+                }
+                deferredContainments.insert(cid, deferred);
+                containmentsIds.insert(cid);
+                continue;
+            }
+        }
+
         //qCDebug(LOG_PLASMA) << "got a containment in the config, trying to make a" << containmentConfig.readEntry("plugin", QString()) << "from" << group;
 #ifndef NDEBUG
         // qCDebug(LOG_PLASMA) << "!!{} STARTUP TIME" << QTime().msecsTo(QTime::currentTime()) << "Adding Containment" << containmentConfig.readEntry("plugin", QString());
 #endif
-        Containment *c = addContainment(containmentConfig.readEntry("plugin", QString()), QVariantList(), cid, -1);
+        Containment *c = addContainment(plugin, QVariantList(), cid, -1);
         if (!c) {
             continue;
         }
@@ -695,6 +878,133 @@ QList<Plasma::Containment *> CoronaPrivate::importLayout(const KConfigGroup &con
     return newContainments;
 }
 
+bool CoronaPrivate::isDeferred(const DeferredContainment &containment) const
+{
+    if (!deferredLoading) {
+        return false;
+    }
+
+    if (!containment.activityId.isEmpty() && !runningActivities.isEmpty()
+        && !runningActivities.contains(containment.activityId)) {
+        return true;
+    }
+
+    // containments not bound to a screen are always loaded
+    return containment.lastScreen >= 0 && !q->screenGeometry(containment.lastScreen).isValid();
+}
+
+QList<Containment *> CoronaPrivate::loadDeferredContainments(const std::function<bool(const DeferredContainment &)> &load)
+{
+    QList<Containment *> loaded;
+    if (deferredContainments.isEmpty()) {
+        return loaded;
+    }
+
+    // take them out first: a containment being created may look for others
+    QVector<QPair<uint, DeferredContainment>> toLoad;
+    for (auto it = deferredContainments.begin(); it != deferredContainments.end();) {
+        if (load(it.value())) {
+            toLoad.append(qMakePair(it.key(), it.value()));
+            it = deferredContainments.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto &deferred : qAsConst(toLoad)) {
+        Containment *c = addContainment(deferred.second.plugin, QVariantList(), deferred.first, -1);
+        if (c) {
+            loaded.append(c);
+        }
+    }
+
+    return loaded;
+}
+
+void CoronaPrivate::scheduleConstraintsFlush(Applet *applet)
+{
+    if (!applet->d->constraintsFlushQueued) {
+        applet->d->constraintsFlushQueued = true;
+        constraintsPending.append(applet);
+    }
+
+    if (!constraintsFlushTimer->isActive()) {
+        constraintsFlushTimer->start();
+    }
+}
+
+// how many applets an applet is nested in, containments included
+static int constraintsDepth(const Applet *applet)
+{
+    int depth = 0;
+    for (QObject *parent = applet->parent(); parent; parent = parent->parent()) {
+        if (qobject_cast<Applet *>(parent)) {
+            ++depth;
+        }
+    }
+    return depth;
+}
+
+void CoronaPrivate::flushPendingConstraints()
+{
+    bool flushed = false;
+    // an applet flushed in this pass and queued again waits for the next one,
+    // so applets queueing themselves from their constraints can't spin here
+    QSet<const Applet *> flushedApplets;
+    QVector<QPointer<Applet>> nextPass;
+
+    // containments go first: the constraints they pass on to their
+    // applets are queued, and flushed in this same pass
+    while (!constraintsPending.isEmpty()) {
+        QVector<QPair<int, QPointer<Applet>>> applets;
+        applets.reserve(constraintsPending.count());
+        for (const QPointer<Applet> &applet : qAsConst(constraintsPending)) {
+            if (!applet) {
+                continue;
+            }
+            if (flushedApplets.contains(applet)) {
+                nextPass.append(applet);
+            } else {
+                applets.append(qMakePair(constraintsDepth(applet), applet));
+            }
+        }
+        constraintsPending.clear();
+
+        std::stable_sort(applets.begin(), applets.end(), [](const QPair<int, QPointer<Applet>> &a1, const QPair<int, QPointer<Applet>> &a2) {
+            return a1.first < a2.first;
+        });
+
+        for (const auto &entry : qAsConst(applets)) {
+            Applet *applet = entry.second;
+            // deleted by the flush of another one
+            if (!applet) {
+                continue;
+            }
+            applet->d->constraintsFlushQueued = false;
+
+            // like Applet::timerEvent(), startup is flushed by addContainment()
+            const Types::Constraints pending = applet->d->pendingConstraints;
+            if (applet->d->transient || pending == Types::NoConstraint || (pending & Types::StartupCompletedConstraint)) {
+                continue;
+            }
+
+            flushedApplets.insert(applet);
+            applet->flushPendingConstraintsEvents();
+            ++constraintsEvents;
+            flushed = true;
+        }
+    }
+
+    if (flushed) {
+        ++constraintsFlushes;
+    }
+
+    if (!nextPass.isEmpty()) {
+        constraintsPending = nextPass;
+        constraintsFlushTimer->start();
+    }
+}
+
 void CoronaPrivate::notifyContainmentsReady()
 {
     containmentsStarting = 0;
@@ -81,7 +81,8 @@ public:
     void setKPackage(const KPackage::Package &package);
 
     /**
-     * @return all containments on this Corona
+     * @return all containments on this Corona, not including the deferred ones
+     * @see setDeferredLoadingEnabled
      */
     QList<Containment *> containments() const;
 
@@ -115,7 +116,7 @@ public:
 
     /**
      * Returns the Containment for a given physical screen and desktop, creating one
-     * if none exists
+     * if none exists. A deferred containment matching them is loaded first.
      *
      * @param screen number of the physical screen to locate
      * @param activity the activity id of the containment we want,
@@ -160,7 +161,8 @@ public:
 #endif
 
     /**
-     * Returns all containments which match a particular activity, for any screen
+     * Returns all containments which match a particular activity, for any screen.
+     * The deferred containments of the activity are loaded first.
      * @param activity the activity id we want
      * @returns the list of matching containments if any, empty if activity is an empty string
      * @since 5.45
@@ -168,13 +170,75 @@ public:
     QList<Containment *> containmentsForActivity(const QString &activity);
 
     /**
-     * Returns all containments which match a particular screen, for any activity
+     * Returns all containments which match a particular screen, for any activity.
+     * The deferred containments of the screen are loaded first.
      * @param screen the screen number we want
      * @returns the list of matching containments if any, empty if screen is < 0
      * @since 5.45
      */
     QList<Containment *> containmentsForScreen(int screen);
 
+    /**
+     * Sets whether loadLayout() defers the containments of activities not running
+     * and of screens not connected: they stay in the configuration, and are created
+     * with their applets only when their activity gets running, their screen is
+     * added, or containmentsForActivity(), containmentsForScreen() or
+     * containmentForScreen() look for them.
+     * A screen is considered connected when screenGeometry() is valid for it.
+     * Disabling it loads all the deferred containments.
+     * It's disabled by default.
+     *
+     * @see setRunningActivities
+     * @since 5.79
+     */
+    void setDeferredLoadingEnabled(bool enabled);
+
+    /**
+     * @return whether the containments of activities not running and of screens
+     * not connected are loaded only when needed
+     * @since 5.79
+     */
+    bool isDeferredLoadingEnabled() const;
+
+    /**
+     * Sets the activities currently running, loading their deferred containments.
+     * As long as this list is empty, no containment is deferred because of
+     * its activity.
+     *
+     * @since 5.79
+     */
+    void setRunningActivities(const QStringList &activities);
+
+    /**
+     * @return the activities currently running
+     * @since 5.79
+     */
+    QStringList runningActivities() const;
+
+    /**
+     * @return the number of containments of the layout not loaded yet
+     * @since 5.79
+     */
+    int deferredContainmentsCount() const;
+
+    /**
+     * The constraints updated on the applets and containments of this Corona
+     * are flushed together, in one pass per event loop iteration, containments
+     * before their applets.
+     *
+     * @return the number of passes that flushed constraints
+     * @since 5.79
+     */
+    quint64 constraintsFlushCount() const;
+
+    /**
+     * @return the number of constraints events those passes delivered,
+     * one per applet or containment flushed
+     * @see constraintsFlushCount
+     * @since 5.79
+     */
+    quint64 constraintsEventCount() const;
+
     /**
      * Returns the number of screens available to plasma.
      * Subclasses should override this method as the default
@@ -213,6 +277,25 @@ public:
      */
     virtual QRect availableScreenRect(int id) const;
 
+    /**
+     * Same as availableScreenRegion(), but kept in a cache until
+     * availableScreenRegionChanged(), availableScreenRectChanged(),
+     * screenGeometryChanged(), screenAdded() or screenRemoved() are emitted. Subclasses reimplementing
+     * availableScreenRegion() must emit those signals for it to stay valid.
+     * @since 5.79
+     */
+    QRegion cachedAvailableScreenRegion(int id) const;
+
+    /**
+     * @returns true if @p rect lies completely inside the available region
+     * of the screen @p id, in the same coordinates as availableScreenRegion().
+     * It works on the cached region and doesn't allocate, so it's suited to
+     * try many placements, like when arranging all the applets of a desktop.
+     * @see cachedAvailableScreenRegion
+     * @since 5.79
+     */
+    bool availableScreenRegionContains(int id, const QRect &rect) const;
+
     /**
      * This method is useful in order to retrieve the list of available
      * screen edges for panel type containments.
@@ -439,6 +522,7 @@ private:
     Q_PRIVATE_SLOT(d, void toggleImmutability())
     Q_PRIVATE_SLOT(d, void containmentReady(bool))
 
+    friend class AppletPrivate;
     friend class CoronaPrivate;
     friend class View;
 };
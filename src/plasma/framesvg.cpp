@@ -11,6 +11,7 @@
 #include <QAtomicInt>
 #include <QBitmap>
 #include <QCryptographicHash>
+#include <QImage>
 #include <QPainter>
 #include <QRegion>
 #include <QSize>
@@ -22,12 +23,14 @@
 #include "theme.h"
 #include "private/svg_p.h"
 #include "private/framesvg_helpers.h"
+#include "private/theme_p.h"
 #include "debug_p.h"
 
 namespace Plasma
 {
 
 QHash<ThemePrivate *, QHash<uint, QWeakPointer<FrameData>> > FrameSvgPrivate::s_sharedFrames;
+QHash<FrameGeometryKey, FrameGeometry> FrameSvgPrivate::s_frameGeometries;
 
 // Any attempt to generate a frame whose width or height is larger than this
 // will be rejected
@@ -38,6 +41,15 @@ FrameData::~FrameData()
     FrameSvgPrivate::s_sharedFrames[theme].remove(cacheId);
 }
 
+uint FrameData::overlayPrefixHash() const
+{
+    if (prefix.constData() != overlayPrefix.constData()) {
+        overlayPrefix = prefix;
+        overlayHash = svgElementHash(prefix % QLatin1String("overlay"));
+    }
+    return overlayHash;
+}
+
 FrameSvg::FrameSvg(QObject *parent)
     : Svg(parent),
       d(new FrameSvgPrivate(this))
@@ -332,7 +344,7 @@ QRegion FrameSvg::mask() const
         return result;
     }
 
-    uint id = qHash(d->cacheId(d->frame.data(), QString()), SvgRectsCache::s_seed);
+    uint id = qHash(d->cacheId(d->frame.data(), svgElementHash(QString())), SvgRectsCache::s_seed);
 
     QRegion* obj = d->frame->cachedMasks.object(id);
 
@@ -459,7 +471,7 @@ QPixmap FrameSvgPrivate::alphaMask()
 
 QSharedPointer<FrameData> FrameSvgPrivate::lookupOrCreateMaskFrame(const QSharedPointer<FrameData> &frame, const QString &maskPrefix, const QString &maskRequestedPrefix)
 {
-    const uint key = qHash(cacheId(frame.data(), maskPrefix));
+    const uint key = qHash(cacheId(frame.data(), svgElementHash(maskPrefix)));
     QSharedPointer<FrameData> mask = s_sharedFrames[q->theme()->d].value(key);
 
     // See if we can find a suitable candidate in the shared frames.
@@ -488,24 +500,34 @@ void FrameSvgPrivate::generateBackground(const QSharedPointer<FrameData> &frame)
         return;
     }
 
-    const uint id = qHash(cacheId(frame.data(), frame->prefix));
+    const QString id = cachePath(frame.data(), frame->prefixHash());
+    const bool dependsOnColors = q->Svg::d->dependsOnColors;
 
     bool frameCached = !frame->cachedBackground.isNull();
     bool overlayCached = false;
     //TODO KF6: Kill Overlays
     const bool overlayAvailable = !frame->prefix.startsWith(QLatin1String("mask-")) && q->hasElement(frame->prefix % QLatin1String("overlay"));
-    QPixmap overlay;
+    // composed as images, which is what the cache stores: only the frame
+    // itself is needed as a pixmap
+    QImage background;
+    QImage overlay;
     if (q->isUsingRenderingCache()) {
-        frameCached = q->theme()->findInCache(QString::number(id), frame->cachedBackground, frame->lastModified) && !frame->cachedBackground.isNull();
+        ThemePrivate *themeD = q->theme()->d;
+        const QString imagePath = q->imagePath();
+        if (themeD->findInCache(id, frame->cachedBackground, frame->lastModified, imagePath, frame->prefix, 1, dependsOnColors)) {
+            frameCached = !frame->cachedBackground.isNull();
+        }
 
         if (overlayAvailable) {
-            const uint overlayId = qHash(cacheId(frame.data(), frame->prefix % QLatin1String("overlay")));
-            overlayCached = q->theme()->findInCache(QString::number(overlayId), overlay, frame->lastModified) && !overlay.isNull();
+            const QString overlayId = cachePath(frame.data(), frame->overlayPrefixHash());
+            if (themeD->findInCache(overlayId, overlay, frame->lastModified, imagePath, frame->prefix % QLatin1String("overlay"), 1, dependsOnColors)) {
+                overlayCached = !overlay.isNull();
+            }
         }
     }
 
     if (!frameCached) {
-        generateFrameBackground(frame);
+        background = generateFrameBackground(frame);
     }
 
     //Overlays
@@ -530,8 +552,13 @@ void FrameSvgPrivate::generateBackground(const QSharedPointer<FrameData> &frame)
             }
         }
 
-        overlay = alphaMask();
+        const QPixmap mask = alphaMask();
+        overlay = QImage(mask.size(), QImage::Format_ARGB32_Premultiplied);
+        overlay.setDevicePixelRatio(mask.devicePixelRatio());
+        overlay.fill(Qt::transparent);
         QPainter overlayPainter(&overlay);
+        overlayPainter.setCompositionMode(QPainter::CompositionMode_Source);
+        overlayPainter.drawPixmap(0, 0, mask);
         overlayPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
         //Tiling?
         if (q->hasElement(frame->prefix % QLatin1String("hint-overlay-tile-horizontal")) ||
@@ -550,17 +577,17 @@ void FrameSvgPrivate::generateBackground(const QSharedPointer<FrameData> &frame)
     }
 
     if (!frameCached) {
-        cacheFrame(frame->prefix, frame->cachedBackground, overlayCached ? overlay : QPixmap());
+        cacheFrame(background, frame->cachedBackground, overlayCached ? overlay : QImage());
     }
 
     if (!overlay.isNull()) {
         QPainter p(&frame->cachedBackground);
         p.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        p.drawPixmap(actualOverlayPos, overlay, QRect(actualOverlayPos, overlaySize));
+        p.drawImage(actualOverlayPos, overlay, QRect(actualOverlayPos, overlaySize));
     }
 }
 
-void FrameSvgPrivate::generateFrameBackground(const QSharedPointer<FrameData> &frame)
+QImage FrameSvgPrivate::generateFrameBackground(const QSharedPointer<FrameData> &frame)
 {
     //qCDebug(LOG_PLASMA) << "generating background";
     const QSize size = frameSize(frame).toSize() * q->devicePixelRatio();
@@ -569,16 +596,16 @@ void FrameSvgPrivate::generateFrameBackground(const QSharedPointer<FrameData> &f
 #ifndef NDEBUG
         // qCDebug(LOG_PLASMA) << "Invalid frame size" << size;
 #endif
-        return;
+        return QImage();
     }
     if (size.width() >= MAX_FRAME_SIZE || size.height() >= MAX_FRAME_SIZE) {
         qCWarning(LOG_PLASMA) << "Not generating frame background for a size whose width or height is more than" << MAX_FRAME_SIZE << size;
-        return;
+        return QImage();
     }
 
-    frame->cachedBackground = QPixmap(size);
-    frame->cachedBackground.fill(Qt::transparent);
-    QPainter p(&frame->cachedBackground);
+    QImage background(size, QImage::Format_ARGB32_Premultiplied);
+    background.fill(Qt::transparent);
+    QPainter p(&background);
     p.setCompositionMode(QPainter::CompositionMode_Source);
     p.setRenderHint(QPainter::SmoothPixmapTransform);
 
@@ -602,7 +629,9 @@ void FrameSvgPrivate::generateFrameBackground(const QSharedPointer<FrameData> &f
     paintBorder(p, frame, FrameSvg::BottomBorder, QSize(bottomWidth, frame->bottomHeight) * q->devicePixelRatio(), contentRect);
     p.end();
 
-    frame->cachedBackground.setDevicePixelRatio(q->devicePixelRatio());
+    background.setDevicePixelRatio(q->devicePixelRatio());
+    frame->cachedBackground = QPixmap::fromImage(background);
+    return background;
 }
 
 QRect FrameSvgPrivate::contentGeometry(const QSharedPointer<FrameData> &frame, const QSize& size) const
@@ -637,7 +666,7 @@ void FrameSvgPrivate::updateFrameData(uint lastModified, UpdateType updateType)
         fd->frameSize = pendingFrameSize;
         fd->imagePath = q->imagePath();
 
-        newKey = qHash(cacheId(fd.data(), prefix));
+        newKey = qHash(cacheId(fd.data(), hashedPrefix.value(prefix)));
 
         //reset frame to old values
         fd->enabledBorders = oldBorders;
@@ -674,7 +703,7 @@ void FrameSvgPrivate::updateFrameData(uint lastModified, UpdateType updateType)
     fd->lastModified = lastModified;
     //was fd just created empty now?
     if (newKey == 0) {
-        newKey = qHash(cacheId(fd.data(), prefix));
+        newKey = qHash(cacheId(fd.data(), hashedPrefix.value(prefix)));
     }
 
     // we know it isn't in s_sharedFrames due to the check above, so insert it now
@@ -754,13 +783,23 @@ void FrameSvgPrivate::paintCorner(QPainter& p, const QSharedPointer<FrameData> &
     }
 }
 
-SvgPrivate::CacheId FrameSvgPrivate::cacheId(FrameData *frame, const QString &prefixToSave) const
+SvgPrivate::CacheId FrameSvgPrivate::cacheId(FrameData *frame, uint prefixHash) const
 {
     const QSize size = frameSize(frame).toSize();
-    return SvgPrivate::CacheId{double(size.width()), double(size.height()), frame->imagePath,  prefixToSave, q->status(), q->devicePixelRatio(), q->scaleFactor(), q->colorGroup(), (uint)frame->enabledBorders, q->Svg::d->lastModified};
+    return SvgPrivate::CacheId{double(size.width()), double(size.height()), frame->imagePathId(), prefixHash, q->status(), q->devicePixelRatio(), q->scaleFactor(), q->colorGroup(), (uint)frame->enabledBorders, q->Svg::d->lastModified};
 }
 
-void FrameSvgPrivate::cacheFrame(const QString &prefixToSave, const QPixmap &background, const QPixmap &overlay)
+QString FrameSvgPrivate::cachePath(FrameData *frame, uint prefixHash) const
+{
+    uint hash = qHash(cacheId(frame, prefixHash));
+    // as for Svg, the renderings using the colors are kept apart for every color scheme
+    if (const uint colors = q->Svg::d->colorsHash()) {
+        hash = qHash(qMakePair(hash, colors), SvgRectsCache::s_seed);
+    }
+    return QString::number(hash);
+}
+
+void FrameSvgPrivate::cacheFrame(const QImage &background, const QPixmap &backgroundPixmap, const QImage &overlay)
 {
     if (!q->isUsingRenderingCache()) {
         return;
@@ -771,16 +810,20 @@ void FrameSvgPrivate::cacheFrame(const QString &prefixToSave, const QPixmap &bac
         return;
     }
 
-    const uint id = qHash(cacheId(frame.data(), prefixToSave));
+    const QString &prefixToSave = frame->prefix;
+    const QString id = cachePath(frame.data(), frame->prefixHash());
+    const bool dependsOnColors = q->Svg::d->dependsOnColors;
 
     //qCDebug(LOG_PLASMA)<<"Saving to cache frame"<<id;
 
-    q->theme()->insertIntoCache(QString::number(id), background, QString::number((qint64)q, 16) % prefixToSave);
+    ThemePrivate *themeD = q->theme()->d;
+    themeD->insertIntoCache(id, background, QString::number((qint64)q, 16) % prefixToSave, q->imagePath(), prefixToSave, dependsOnColors, backgroundPixmap);
 
     if (!overlay.isNull()) {
         //insert overlay
-        const uint overlayId = qHash(cacheId(frame.data(), frame->prefix % QLatin1String("overlay")));
-        q->theme()->insertIntoCache(QString::number(overlayId), overlay, QString::number((qint64)q, 16) % prefixToSave % QLatin1String("overlay"));
+        const QString overlayId = cachePath(frame.data(), frame->overlayPrefixHash());
+        themeD->insertIntoCache(overlayId, overlay, QString::number((qint64)q, 16) % prefixToSave % QLatin1String("overlay"),
+                                q->imagePath(), prefixToSave % QLatin1String("overlay"), dependsOnColors);
     }
 }
 
@@ -789,20 +832,16 @@ void FrameSvgPrivate::updateSizes(FrameData *frame) const
     //qCDebug(LOG_PLASMA) << "!!!!!!!!!!!!!!!!!!!!!! updating sizes" << prefix;
     Q_ASSERT(frame);
 
-    QSize s = q->size();
-    q->resize();
     if (!frame->cachedBackground.isNull()) {
         frame->cachedBackground = QPixmap();
     }
 
-    //This has the same size regardless the border is enabled or not
-    frame->fixedTopHeight = q->elementSize(frame->prefix % QLatin1String("top")).height();
+    const FrameGeometry geometry = frameGeometry(frame);
 
-    if (q->hasElement(frame->prefix % QLatin1String("hint-top-margin"))) {
-        frame->fixedTopMargin = q->elementSize(frame->prefix % QLatin1String("hint-top-margin")).height();
-    } else {
-        frame->fixedTopMargin = frame->fixedTopHeight;
-    }
+    //This has the same size regardless the border is enabled or not
+    frame->fixedTopHeight = geometry.fixedTopHeight;
+    frame->fixedTopMargin = geometry.fixedTopMargin;
+    frame->insetTopMargin = geometry.insetTopMargin;
 
     //The same, but its size depends from the margin being enabled
     if (frame->enabledBorders & FrameSvg::TopBorder) {
@@ -812,19 +851,9 @@ void FrameSvgPrivate::updateSizes(FrameData *frame) const
         frame->topMargin = frame->topHeight = 0;
     }
 
-    if (q->hasElement(frame->prefix % QLatin1String("hint-top-inset"))) {
-        frame->insetTopMargin = q->elementSize(frame->prefix % QLatin1String("hint-top-inset")).height();
-    } else {
-        frame->insetTopMargin = -1;
-    }
-
-    frame->fixedLeftWidth = q->elementSize(frame->prefix % QLatin1String("left")).width();
-
-    if (q->hasElement(frame->prefix % QLatin1String("hint-left-margin"))) {
-        frame->fixedLeftMargin = q->elementSize(frame->prefix % QLatin1String("hint-left-margin")).width();
-    } else {
-        frame->fixedLeftMargin = frame->fixedLeftWidth;
-    }
+    frame->fixedLeftWidth = geometry.fixedLeftWidth;
+    frame->fixedLeftMargin = geometry.fixedLeftMargin;
+    frame->insetLeftMargin = geometry.insetLeftMargin;
 
     if (frame->enabledBorders & FrameSvg::LeftBorder) {
         frame->leftMargin = frame->fixedLeftMargin;
@@ -833,19 +862,9 @@ void FrameSvgPrivate::updateSizes(FrameData *frame) const
         frame->leftMargin = frame->leftWidth = 0;
     }
 
-    if (q->hasElement(frame->prefix % QLatin1String("hint-left-inset"))) {
-        frame->insetLeftMargin = q->elementSize(frame->prefix % QLatin1String("hint-left-inset")).width();
-    } else {
-        frame->insetLeftMargin = -1;
-    }
-
-    frame->fixedRightWidth = q->elementSize(frame->prefix % QLatin1String("right")).width();
-
-    if (q->hasElement(frame->prefix % QLatin1String("hint-right-margin"))) {
-        frame->fixedRightMargin = q->elementSize(frame->prefix % QLatin1String("hint-right-margin")).width();
-    } else {
-        frame->fixedRightMargin = frame->fixedRightWidth;
-    }
+    frame->fixedRightWidth = geometry.fixedRightWidth;
+    frame->fixedRightMargin = geometry.fixedRightMargin;
+    frame->insetRightMargin = geometry.insetRightMargin;
 
     if (frame->enabledBorders & FrameSvg::RightBorder) {
         frame->rightMargin = frame->fixedRightMargin;
@@ -854,19 +873,9 @@ void FrameSvgPrivate::updateSizes(FrameData *frame) const
         frame->rightMargin = frame->rightWidth = 0;
     }
 
-    if (q->hasElement(frame->prefix % QLatin1String("hint-right-inset"))) {
-        frame->insetRightMargin = q->elementSize(frame->prefix % QLatin1String("hint-right-inset")).width();
-    } else {
-        frame->insetRightMargin = -1;
-    }
-
-    frame->fixedBottomHeight = q->elementSize(frame->prefix % QLatin1String("bottom")).height();
-
-    if (q->hasElement(frame->prefix % QLatin1String("hint-bottom-margin"))) {
-        frame->fixedBottomMargin = q->elementSize(frame->prefix % QLatin1String("hint-bottom-margin")).height();
-    } else {
-        frame->fixedBottomMargin = frame->fixedBottomHeight;
-    }
+    frame->fixedBottomHeight = geometry.fixedBottomHeight;
+    frame->fixedBottomMargin = geometry.fixedBottomMargin;
+    frame->insetBottomMargin = geometry.insetBottomMargin;
 
     if (frame->enabledBorders & FrameSvg::BottomBorder) {
         frame->bottomMargin = frame->fixedBottomMargin;
@@ -875,21 +884,85 @@ void FrameSvgPrivate::updateSizes(FrameData *frame) const
         frame->bottomMargin = frame->bottomHeight = 0;
     }
 
-    if (q->hasElement(frame->prefix % QLatin1String("hint-bottom-inset"))) {
-        frame->insetBottomMargin = q->elementSize(frame->prefix % QLatin1String("hint-bottom-inset")).height();
-    } else {
-        frame->insetBottomMargin = -1;
+    frame->composeOverBorder = geometry.composeOverBorder;
+    frame->tileCenter = geometry.tileCenter;
+    frame->noBorderPadding = geometry.noBorderPadding;
+    frame->stretchBorders = geometry.stretchBorders;
+}
+
+FrameGeometryKey FrameSvgPrivate::frameGeometryKey(uint prefixHash) const
+{
+    const SvgPrivate *svgD = q->Svg::d;
+    return FrameGeometryKey{svgD->pathId(), prefixHash, svgD->status, svgD->devicePixelRatio, svgD->scaleFactor, svgD->lastModified};
+}
+
+FrameGeometry FrameSvgPrivate::frameGeometry(FrameData *frame) const
+{
+    // the path of a themed svg is resolved lazily by the first element lookup,
+    // until then there is nothing stable to key the geometry on
+    if (!q->Svg::d->path.isEmpty()) {
+        auto it = s_frameGeometries.constFind(frameGeometryKey(frame->prefixHash()));
+        if (it != s_frameGeometries.constEnd()) {
+            return *it;
+        }
     }
 
-    frame->composeOverBorder = (q->hasElement(frame->prefix % QLatin1String("hint-compose-over-border")) &&
-                                q->hasElement(QLatin1String("mask-") % frame->prefix % QLatin1String("center")));
+    // element sizes are measured at the natural size of the svg
+    const QSize s = q->size();
+    q->resize();
+    const FrameGeometry geometry = measureFrameGeometry(frame->prefix);
+    q->resize(s);
+
+    if (!q->Svg::d->path.isEmpty()) {
+        s_frameGeometries.insert(frameGeometryKey(frame->prefixHash()), geometry);
+    }
+    return geometry;
+}
+
+FrameGeometry FrameSvgPrivate::measureFrameGeometry(const QString &prefixToUse) const
+{
+    // every element is looked up only once, an invalid rect means it doesn't exist
+    SvgPrivate *svgD = q->Svg::d;
+    auto rect = [svgD, &prefixToUse](const QLatin1String &element) {
+        return svgD->elementRect(prefixToUse % element);
+    };
+
+    FrameGeometry geometry;
+
+    geometry.fixedTopHeight = rect(QLatin1String("top")).size().toSize().height();
+    const QRectF topMarginHint = rect(QLatin1String("hint-top-margin"));
+    geometry.fixedTopMargin = topMarginHint.isValid() ? topMarginHint.size().toSize().height() : geometry.fixedTopHeight;
+    const QRectF topInsetHint = rect(QLatin1String("hint-top-inset"));
+    geometry.insetTopMargin = topInsetHint.isValid() ? topInsetHint.size().toSize().height() : -1;
+
+    geometry.fixedLeftWidth = rect(QLatin1String("left")).size().toSize().width();
+    const QRectF leftMarginHint = rect(QLatin1String("hint-left-margin"));
+    geometry.fixedLeftMargin = leftMarginHint.isValid() ? leftMarginHint.size().toSize().width() : geometry.fixedLeftWidth;
+    const QRectF leftInsetHint = rect(QLatin1String("hint-left-inset"));
+    geometry.insetLeftMargin = leftInsetHint.isValid() ? leftInsetHint.size().toSize().width() : -1;
+
+    geometry.fixedRightWidth = rect(QLatin1String("right")).size().toSize().width();
+    const QRectF rightMarginHint = rect(QLatin1String("hint-right-margin"));
+    geometry.fixedRightMargin = rightMarginHint.isValid() ? rightMarginHint.size().toSize().width() : geometry.fixedRightWidth;
+    const QRectF rightInsetHint = rect(QLatin1String("hint-right-inset"));
+    geometry.insetRightMargin = rightInsetHint.isValid() ? rightInsetHint.size().toSize().width() : -1;
+
+    geometry.fixedBottomHeight = rect(QLatin1String("bottom")).size().toSize().height();
+    const QRectF bottomMarginHint = rect(QLatin1String("hint-bottom-margin"));
+    geometry.fixedBottomMargin = bottomMarginHint.isValid() ? bottomMarginHint.size().toSize().height() : geometry.fixedBottomHeight;
+    const QRectF bottomInsetHint = rect(QLatin1String("hint-bottom-inset"));
+    geometry.insetBottomMargin = bottomInsetHint.isValid() ? bottomInsetHint.size().toSize().height() : -1;
+
+    geometry.composeOverBorder = rect(QLatin1String("hint-compose-over-border")).isValid() &&
+                                 svgD->elementRect(QLatin1String("mask-") % prefixToUse % QLatin1String("center")).isValid();
 
     //since it's rectangular, topWidth and bottomWidth must be the same
-    //the ones that don't have a frame->prefix is for retrocompatibility
-    frame->tileCenter = (q->hasElement(QStringLiteral("hint-tile-center")) || q->hasElement(frame->prefix % QLatin1String("hint-tile-center")));
-    frame->noBorderPadding = (q->hasElement(QStringLiteral("hint-no-border-padding")) || q->hasElement(frame->prefix % QLatin1String("hint-no-border-padding")));
-    frame->stretchBorders = (q->hasElement(QStringLiteral("hint-stretch-borders")) || q->hasElement(frame->prefix % QLatin1String("hint-stretch-borders")));
-    q->resize(s);
+    //the ones that don't have a prefix is for retrocompatibility
+    geometry.tileCenter = svgD->elementRect(QStringLiteral("hint-tile-center")).isValid() || rect(QLatin1String("hint-tile-center")).isValid();
+    geometry.noBorderPadding = svgD->elementRect(QStringLiteral("hint-no-border-padding")).isValid() || rect(QLatin1String("hint-no-border-padding")).isValid();
+    geometry.stretchBorders = svgD->elementRect(QStringLiteral("hint-stretch-borders")).isValid() || rect(QLatin1String("hint-stretch-borders")).isValid();
+
+    return geometry;
 }
 
 void FrameSvgPrivate::updateNeeded()
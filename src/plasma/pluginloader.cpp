@@ -6,10 +6,14 @@
 
 #include "pluginloader.h"
 
+#include <QMimeDatabase>
+#include <QCoreApplication>
 #include <QPointer>
 #include <QStandardPaths>
+#include <QThread>
 
 #include <QDebug>
+#include <KDirWatch>
 #include <KService>
 #include <KServiceTypeTrader>
 #include <KPluginTrader>
@@ -74,6 +78,46 @@ public:
     Cache plasmoidCache;
     Cache dataengineCache;
     Cache containmentactionCache;
+
+    class DropIndex {
+        // Which applets accept which drops, by mime type and by url pattern.
+        // It's built on the first drop and thrown away when plasmoid packages
+        // get installed or removed, so a drop doesn't go through every package.
+        // It isn't locked and relies on KDirWatch, so it's only to be used
+        // from the thread of the application, the gui thread.
+    public:
+        ~DropIndex();
+
+        QList<KPluginMetaData> appletsForMimeType(const QString &mimeType);
+        QList<KPluginMetaData> appletsForUrl(const QUrl &url, const QString &parentApp);
+
+    private:
+        struct UrlPattern {
+            QRegExp glob;
+            // in the order of the applets and of their patterns
+            int order;
+            int applet;
+        };
+
+        void build();
+        void invalidate();
+        void watchPackages();
+        void watchMetaDataFiles();
+        static QString globScheme(const QString &glob);
+
+        bool built = false;
+        QVector<KPluginMetaData> applets;
+        QVector<QString> parentApps;
+        QHash<QString, QVector<int>> mimeTypes;
+        // patterns by the scheme they begin with, the ones beginning
+        // with a wildcard are under an empty scheme
+        QHash<QString, QVector<UrlPattern>> urlPatterns;
+        QHash<QString, QStringList> mimeAncestors;
+        QVector<QMetaObject::Connection> watchConnections;
+        // the metadata of the indexed packages, which can change in place
+        QSet<QString> watchedFiles;
+    };
+    DropIndex dropIndex;
 };
 
 QSet<QString> PluginLoaderPrivate::s_customCategories;
@@ -566,11 +610,7 @@ QT_WARNING_POP
 
 QList<KPluginMetaData> PluginLoader::listAppletMetaDataForMimeType(const QString &mimeType)
 {
-    auto filter = [&mimeType](const KPluginMetaData &md) -> bool
-    {
-        return KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-DropMimeTypes")).contains(mimeType);
-    };
-    return KPackage::PackageLoader::self()->findPackages(QStringLiteral("Plasma/Applet"), QString(), filter);
+    return d->dropIndex.appletsForMimeType(mimeType);
 }
 
 KPluginInfo::List PluginLoader::listAppletInfoForMimeType(const QString &mimeType)
@@ -586,29 +626,7 @@ QList<KPluginMetaData> PluginLoader::listAppletMetaDataForUrl(const QUrl &url)
         parentApp = app->applicationName();
     }
 
-    auto filter = [&parentApp](const KPluginMetaData &md) -> bool
-    {
-        const QString pa = md.value(QStringLiteral("X-KDE-ParentApp"));
-        return (parentApp.isEmpty() || pa == parentApp) && !KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-DropUrlPatterns")).isEmpty();
-    };
-    const QList<KPluginMetaData> allApplets = KPackage::PackageLoader::self()->findPackages(QStringLiteral("Plasma/Applet"), QString(), filter);
-
-    QList<KPluginMetaData> filtered;
-    for (const KPluginMetaData &md : allApplets) {
-        const QStringList urlPatterns = KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-DropUrlPatterns"));
-        for (const QString &glob : urlPatterns) {
-            QRegExp rx(glob);
-            rx.setPatternSyntax(QRegExp::Wildcard);
-            if (rx.exactMatch(url.toString())) {
-#ifndef NDEBUG
-                // qCDebug(LOG_PLASMA) << md.name() << "matches" << glob << url;
-#endif
-                filtered << md;
-            }
-        }
-    }
-
-    return filtered;
+    return d->dropIndex.appletsForUrl(url, parentApp);
 }
 
 KPluginInfo::List PluginLoader::listAppletInfoForUrl(const QUrl &url)
@@ -918,6 +936,205 @@ bool PluginLoader::isPluginVersionCompatible(KPluginLoader &loader)
     return true;
 }
 
+PluginLoaderPrivate::DropIndex::~DropIndex()
+{
+    for (const auto &connection : qAsConst(watchConnections)) {
+        QObject::disconnect(connection);
+    }
+}
+
+QList<KPluginMetaData> PluginLoaderPrivate::DropIndex::appletsForMimeType(const QString &mimeType)
+{
+    Q_ASSERT(!QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread());
+
+    if (!built) {
+        build();
+    }
+
+    auto ancestorsIt = mimeAncestors.constFind(mimeType);
+    if (ancestorsIt == mimeAncestors.constEnd()) {
+        // an applet accepting text/plain also accepts, say, text/x-csrc
+        QStringList names;
+        const QMimeType type = QMimeDatabase().mimeTypeForName(mimeType);
+        if (type.isValid()) {
+            if (type.name() != mimeType) {
+                names << type.name();
+            }
+            names << type.allAncestors();
+        }
+        ancestorsIt = mimeAncestors.insert(mimeType, names);
+    }
+
+    QList<KPluginMetaData> found;
+    QVector<int> seen;
+
+    auto collect = [this, &found, &seen](const QString &name) {
+        const auto it = mimeTypes.constFind(name);
+        if (it == mimeTypes.constEnd()) {
+            return;
+        }
+        for (int applet : *it) {
+            if (!seen.contains(applet)) {
+                seen << applet;
+                found << applets.at(applet);
+            }
+        }
+    };
+
+    collect(mimeType);
+    for (const QString &ancestor : *ancestorsIt) {
+        collect(ancestor);
+    }
+
+    return found;
+}
+
+QList<KPluginMetaData> PluginLoaderPrivate::DropIndex::appletsForUrl(const QUrl &url, const QString &parentApp)
+{
+    Q_ASSERT(!QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread());
+
+    if (!built) {
+        build();
+    }
+
+    const QString urlString = url.toString();
+    QVector<QPair<int, int>> matches;
+
+    auto match = [this, &urlString, &parentApp, &matches](const QString &scheme) {
+        auto it = urlPatterns.find(scheme);
+        if (it == urlPatterns.end()) {
+            return;
+        }
+        for (UrlPattern &pattern : *it) {
+            if ((parentApp.isEmpty() || parentApps.at(pattern.applet) == parentApp) && pattern.glob.exactMatch(urlString)) {
+                matches << qMakePair(pattern.order, pattern.applet);
+            }
+        }
+    };
+
+    if (!url.scheme().isEmpty()) {
+        match(url.scheme());
+    }
+    match(QString());
+
+    // same order as going through every applet and every pattern
+    std::sort(matches.begin(), matches.end());
+
+    QList<KPluginMetaData> filtered;
+    for (const auto &found : qAsConst(matches)) {
+        filtered << applets.at(found.second);
+    }
+    return filtered;
+}
+
+void PluginLoaderPrivate::DropIndex::build()
+{
+    watchPackages();
+
+    auto filter = [](const KPluginMetaData &md) -> bool
+    {
+        return !KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-DropMimeTypes")).isEmpty()
+            || !KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-DropUrlPatterns")).isEmpty();
+    };
+    const QList<KPluginMetaData> dropApplets = KPackage::PackageLoader::self()->findPackages(QStringLiteral("Plasma/Applet"), QString(), filter);
+
+    int order = 0;
+    for (const KPluginMetaData &md : dropApplets) {
+        const int applet = applets.count();
+        applets << md;
+        parentApps << md.value(QStringLiteral("X-KDE-ParentApp"));
+
+        const QStringList dropMimeTypes = KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-DropMimeTypes"));
+        for (const QString &mimeType : dropMimeTypes) {
+            QVector<int> &mimeApplets = mimeTypes[mimeType];
+            if (mimeApplets.isEmpty() || mimeApplets.constLast() != applet) {
+                mimeApplets << applet;
+            }
+        }
+
+        const QStringList dropUrlPatterns = KPluginMetaData::readStringList(md.rawData(), QStringLiteral("X-Plasma-DropUrlPatterns"));
+        for (const QString &glob : dropUrlPatterns) {
+            QRegExp rx(glob);
+            rx.setPatternSyntax(QRegExp::Wildcard);
+            urlPatterns[globScheme(glob)] << UrlPattern{rx, order++, applet};
+        }
+    }
+
+    watchMetaDataFiles();
+    built = true;
+}
+
+void PluginLoaderPrivate::DropIndex::invalidate()
+{
+    built = false;
+    applets.clear();
+    parentApps.clear();
+    mimeTypes.clear();
+    urlPatterns.clear();
+}
+
+void PluginLoaderPrivate::DropIndex::watchPackages()
+{
+    if (!watchConnections.isEmpty()) {
+        return;
+    }
+
+    // a package being installed or removed adds or removes a directory in one of these
+    const QStringList dataDirs = QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation);
+    for (const QString &dataDir : dataDirs) {
+        KDirWatch::self()->addDir(dataDir + QStringLiteral("/" PLASMA_RELATIVE_DATA_INSTALL_DIR "/plasmoids"));
+    }
+
+    auto changed = [this](const QString &path) {
+        if (path.contains(QLatin1String(PLASMA_RELATIVE_DATA_INSTALL_DIR "/plasmoids")) || watchedFiles.contains(path)) {
+            invalidate();
+        }
+    };
+    watchConnections << QObject::connect(KDirWatch::self(), &KDirWatch::dirty, changed);
+    watchConnections << QObject::connect(KDirWatch::self(), &KDirWatch::created, changed);
+    watchConnections << QObject::connect(KDirWatch::self(), &KDirWatch::deleted, changed);
+}
+
+void PluginLoaderPrivate::DropIndex::watchMetaDataFiles()
+{
+    // the directory watches only see packages come and go, a package whose
+    // metadata gets rewritten in place can change what it accepts: watch the
+    // metadata of the indexed ones, there are only a few of them
+    QSet<QString> files;
+    for (const KPluginMetaData &md : qAsConst(applets)) {
+        if (!md.metaDataFileName().isEmpty()) {
+            files.insert(md.metaDataFileName());
+        }
+    }
+
+    for (const QString &file : qAsConst(watchedFiles)) {
+        if (!files.contains(file)) {
+            KDirWatch::self()->removeFile(file);
+        }
+    }
+    for (const QString &file : qAsConst(files)) {
+        if (!watchedFiles.contains(file)) {
+            KDirWatch::self()->addFile(file);
+        }
+    }
+    watchedFiles.swap(files);
+}
+
+QString PluginLoaderPrivate::DropIndex::globScheme(const QString &glob)
+{
+    // the literal scheme the pattern begins with, if any
+    for (int i = 0; i < glob.length(); ++i) {
+        const QChar c = glob.at(i);
+        if (c == QLatin1Char(':')) {
+            return glob.left(i);
+        }
+        if (!c.isLetterOrNumber() && c != QLatin1Char('+') && c != QLatin1Char('-') && c != QLatin1Char('.')) {
+            break;
+        }
+    }
+    return QString();
+}
+
 QVector<KPluginMetaData> PluginLoaderPrivate::Cache::findPluginsById(const QString& name, const QStringList &dirs)
 {
     const qint64 now = qRound64(QDateTime::currentMSecsSinceEpoch() / 1000.0);
@@ -203,6 +203,11 @@ public:
 
     /**
      * Returns a list of all known applets associated with a certain mimetype.
+     * Applets associated with a mimetype it inherits from come after the
+     * ones associated with the mimetype itself.
+     *
+     * @note The answers are kept in an index, this is only to be called
+     * from the gui thread.
      *
      * @return list of applets
      * @since 5.36
@@ -224,6 +229,9 @@ public:
     /**
      * Returns a list of all known applets associated with a certain URL.
      *
+     * @note The answers are kept in an index, this is only to be called
+     * from the gui thread.
+     *
      * @return list of applets
      * @since 5.36
      **/
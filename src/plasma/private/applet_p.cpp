@@ -33,6 +33,7 @@
 #include "scripting/scriptengine.h"
 #include "scripting/appletscript.h"
 #include "private/containment_p.h"
+#include "private/corona_p.h"
 #include "private/package_p.h"
 #include "timetracker.h"
 #include "debug_p.h"
@@ -62,6 +63,7 @@ AppletPrivate::AppletPrivate(const KPluginMetaData &info, int uniqueID, Applet *
       transient(false),
       needsConfig(false),
       started(false),
+      constraintsFlushQueued(false),
       globalShortcutEnabled(false),
       userConfiguring(false),
       busy(false)
@@ -487,8 +489,14 @@ void AppletPrivate::scheduleConstraintsUpdate(Plasma::Types::Constraints c)
 {
     // Don't start up a timer if we're just starting up
     // flushPendingConstraints will be called by Corona
-    if (started && !constraintsTimer.isActive() && !(c & Plasma::Types::StartupCompletedConstraint)) {
-        constraintsTimer.start(0, q);
+    if (started && !(c & Plasma::Types::StartupCompletedConstraint)) {
+        Corona *corona = q->containment() ? q->containment()->corona() : nullptr;
+        if (corona) {
+            // flushed together with the rest of the Corona
+            corona->d->scheduleConstraintsFlush(q);
+        } else if (!constraintsTimer.isActive()) {
+            constraintsTimer.start(0, q);
+        }
     }
 
     if (c & Plasma::Types::StartupCompletedConstraint) {
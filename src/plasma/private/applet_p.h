@@ -108,6 +108,8 @@ public:
     bool transient : 1;
     bool needsConfig : 1;
     bool started : 1;
+    // waiting in the constraints flush of the Corona
+    bool constraintsFlushQueued : 1;
     bool globalShortcutEnabled : 1;
     bool userConfiguring : 1;
     bool busy : 1;
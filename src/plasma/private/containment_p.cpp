@@ -198,6 +198,40 @@ Applet *ContainmentPrivate::createApplet(const QString &name, const QVariantList
     return applet;
 }
 
+QVector<ContainmentPrivate::LayoutApplet> ContainmentPrivate::layoutApplets(const KConfigGroup &appletsGroup)
+{
+    struct SortedApplet {
+        int order;
+        LayoutApplet applet;
+    };
+
+    // ordered by id, then by their "id" entry if any: read each entry once,
+    // rather than once per comparison
+    QStringList groups = appletsGroup.groupList();
+    std::sort(groups.begin(), groups.end());
+
+    QVector<SortedApplet> sorted;
+    sorted.reserve(groups.count());
+    for (const QString &group : qAsConst(groups)) {
+        const KConfigGroup appletConfig(&appletsGroup, group);
+        const QString plugin = appletConfig.readEntry("plugin", QString());
+        if (plugin.isEmpty()) {
+            continue;
+        }
+        sorted.append({appletConfig.readEntry("id", 0), {group.toUInt(), plugin}});
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const SortedApplet &a1, const SortedApplet &a2) {
+        return a1.order < a2.order;
+    });
+
+    QVector<LayoutApplet> applets;
+    applets.reserve(sorted.count());
+    for (const SortedApplet &entry : qAsConst(sorted)) {
+        applets.append(entry.applet);
+    }
+    return applets;
+}
+
 void ContainmentPrivate::appletDeleted(Plasma::Applet *applet)
 {
     applets.removeAll(applet);
@@ -10,6 +10,7 @@
 
 #include <KActionCollection>
 #include <QSet>
+#include <QVector>
 
 #include "plasma.h"
 #include "applet.h"
@@ -50,6 +51,13 @@ public:
 
     Applet *createApplet(const QString &name, const QVariantList &args = QVariantList(), uint id = 0);
 
+    // an applet of the layout, in the order restoreContents() creates them
+    struct LayoutApplet {
+        uint id;
+        QString plugin;
+    };
+    static QVector<LayoutApplet> layoutApplets(const KConfigGroup &appletsGroup);
+
     /**
      * FIXME: this should completely go from here
      * @return the config group that containmentactions plugins go in
@@ -78,6 +86,8 @@ public:
     QHash<QString, ContainmentActions *> localActionPlugins;
     int lastScreen;
     QString activityId;
+    // the applet being restored from the layout, its configuration is known to be there
+    uint restoringAppletId = 0;
     Types::ContainmentType type;
     bool uiReady : 1;
     bool appletsUiReady : 1;
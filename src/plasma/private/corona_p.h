@@ -7,17 +7,25 @@
 #ifndef PLASMA_CORONA_P_H
 #define PLASMA_CORONA_P_H
 
+#include <QHash>
+#include <QMap>
+#include <QPointer>
+#include <QRegion>
 #include <QTimer>
+#include <QVector>
 
 #include <KActionCollection>
 
 #include "package.h"
 
+#include <functional>
+
 class KShortcutsDialog;
 
 namespace Plasma
 {
 
+class Applet;
 class Containment;
 
 class CoronaPrivate
@@ -33,10 +41,31 @@ public:
     void containmentDestroyed(QObject *obj);
     void syncConfig();
     void notifyContainmentsReady();
+    void scheduleConstraintsFlush(Applet *applet);
+    void flushPendingConstraints();
     void containmentReady(bool ready);
     Containment *addContainment(const QString &name, const QVariantList &args, uint id, int lastScreen, bool delayedInit = false);
     QList<Plasma::Containment *> importLayout(const KConfigGroup &conf, bool mergeConfig);
 
+    // a containment of the layout left in the configuration by importLayout()
+    struct DeferredContainment {
+        QString plugin;
+        QString activityId;
+        int lastScreen;
+    };
+    bool isDeferred(const DeferredContainment &containment) const;
+    QList<Containment *> loadDeferredContainments(const std::function<bool(const DeferredContainment &)> &load);
+
+    // availableScreenRegion() of a screen, as of the given version of the screens layout
+    struct AvailableRegion {
+        quint64 version = 0;
+        QRegion region;
+        // the rects of the region, not overlapping, sorted by top then left
+        QVector<QRect> rects;
+    };
+    const AvailableRegion &availableRegion(int id);
+    void invalidateAvailableRegions();
+
     Corona *q;
     KPackage::Package package;
     KConfigGroup desktopDefaultsConfig;
@@ -48,6 +77,16 @@ public:
     KActionCollection actions;
     int containmentsStarting;
     bool editMode = false;
+    QHash<int, AvailableRegion> availableRegions;
+    // by id
+    QMap<uint, DeferredContainment> deferredContainments;
+    QStringList runningActivities;
+    bool deferredLoading = false;
+    QTimer *constraintsFlushTimer;
+    QVector<QPointer<Applet>> constraintsPending;
+    quint64 constraintsFlushes = 0;
+    quint64 constraintsEvents = 0;
+    quint64 availableRegionsVersion = 1;
 };
 
 }
@@ -9,9 +9,12 @@
 #define PLASMA_FRAMESVG_P_H
 
 #include <QHash>
+#include <QImage>
 #include <QCache>
 #include <QStringBuilder>
 
+#include <array>
+
 #include <QDebug>
 
 #include <Plasma/Theme>
@@ -70,6 +73,18 @@ public:
 
     ~FrameData();
 
+    // the image path and prefixes as used in the cache ids, derived again
+    // only when the strings change
+    uint imagePathId() const
+    {
+        return internedImagePath.value(imagePath);
+    }
+    uint prefixHash() const
+    {
+        return hashedPrefix.value(prefix);
+    }
+    uint overlayPrefixHash() const;
+
     QString imagePath;
     QString prefix;
     QString requestedPrefix;
@@ -122,6 +137,71 @@ public:
     bool composeOverBorder : 1;
 
     Plasma::ThemePrivate *theme;
+
+private:
+    SvgPathId internedImagePath;
+    SvgElementHash hashedPrefix;
+    mutable QString overlayPrefix;
+    mutable uint overlayHash = svgElementHash(QStringLiteral("overlay"));
+};
+
+// Sizes and hints of the elements of one frame prefix, measured at the
+// natural size of the svg: they don't depend on the frame size or on the
+// enabled borders, so they can be shared by all the frames using the prefix
+struct FrameGeometry
+{
+    int fixedTopHeight = 0;
+    int fixedLeftWidth = 0;
+    int fixedRightWidth = 0;
+    int fixedBottomHeight = 0;
+
+    int fixedTopMargin = 0;
+    int fixedLeftMargin = 0;
+    int fixedRightMargin = 0;
+    int fixedBottomMargin = 0;
+
+    int insetTopMargin = -1;
+    int insetLeftMargin = -1;
+    int insetRightMargin = -1;
+    int insetBottomMargin = -1;
+
+    bool noBorderPadding = false;
+    bool stretchBorders = false;
+    bool tileCenter = false;
+    bool composeOverBorder = false;
+};
+
+// What the geometry of a prefix depends on, compared in full so that
+// two svgs colliding in the hash can't get each other's margins
+struct FrameGeometryKey
+{
+    uint pathId; // interned with SvgStringTable
+    uint prefixHash; // svgElementHash() of the prefix
+    int status;
+    double devicePixelRatio;
+    double scaleFactor;
+    uint lastModified;
+
+    bool operator==(const FrameGeometryKey &other) const
+    {
+        return pathId == other.pathId && prefixHash == other.prefixHash && status == other.status
+            && devicePixelRatio == other.devicePixelRatio && scaleFactor == other.scaleFactor
+            && lastModified == other.lastModified;
+    }
+
+    // only found through the key, so it doesn't hide the other qHash overloads
+    friend uint qHash(const FrameGeometryKey &key, uint seed = 0)
+    {
+        std::array<uint, 6> parts = {
+            SvgStringTable::hash(key.pathId),
+            key.prefixHash,
+            ::qHash(key.status),
+            ::qHash(key.devicePixelRatio),
+            ::qHash(key.scaleFactor),
+            ::qHash(key.lastModified)
+        };
+        return qHashRange(parts.begin(), parts.end(), seed);
+    }
 };
 
 class FrameSvgPrivate
@@ -146,10 +226,17 @@ public:
     };
 
     void generateBackground(const QSharedPointer<FrameData> &frame);
-    void generateFrameBackground(const QSharedPointer<FrameData> &);
-    SvgPrivate::CacheId cacheId(FrameData *frame, const QString &prefixToUse) const;
-    void cacheFrame(const QString &prefixToSave, const QPixmap &background, const QPixmap &overlay);
+    // also returns the background as an image, for the cache
+    QImage generateFrameBackground(const QSharedPointer<FrameData> &);
+    // prefixHash is svgElementHash() of the prefix
+    SvgPrivate::CacheId cacheId(FrameData *frame, uint prefixHash) const;
+    // the key of a rendering in the theme cache
+    QString cachePath(FrameData *frame, uint prefixHash) const;
+    void cacheFrame(const QImage &background, const QPixmap &backgroundPixmap, const QImage &overlay);
     void updateSizes(FrameData* frame) const;
+    FrameGeometry frameGeometry(FrameData *frame) const;
+    FrameGeometry measureFrameGeometry(const QString &prefixToUse) const;
+    FrameGeometryKey frameGeometryKey(uint prefixHash) const;
     void updateSizes(const QSharedPointer<FrameData> &frame) const { return updateSizes(frame.data()); }
     void updateNeeded();
     void updateAndSignalSizes();
@@ -167,6 +254,7 @@ public:
     //sometimes the prefix we requested is not available, so prefix will be emoty
     //keep track of the requested one anyways, we'll try again when the theme changes
     QString requestedPrefix;
+    SvgElementHash hashedPrefix;
 
     FrameSvg * const q;
 
@@ -181,6 +269,8 @@ public:
     QSize pendingFrameSize;
 
     static QHash<ThemePrivate *, QHash<uint, QWeakPointer<FrameData>> > s_sharedFrames;
+    // shared by all the themes, emptied whenever a theme changes
+    static QHash<FrameGeometryKey, FrameGeometry> s_frameGeometries;
 
     bool cacheAll : 1;
     bool repaintBlocked : 1;
@@ -19,6 +19,28 @@ namespace Plasma
 
 class Svg;
 
+// The contents of an svg file, read and preprocessed only once no matter how
+// many color groups and statuses it gets rendered with: the current color
+// scheme stylesheet is spliced in between the parts
+class SvgSource : public QSharedData
+{
+public:
+    typedef QExplicitlySharedDataPointer<SvgSource> Ptr;
+
+    explicit SvgSource(const QByteArray &contents);
+    static Ptr fromFile(const QString &filename);
+
+    bool usesColorScheme() const;
+    QByteArray contents(const QString &styleSheet) const;
+
+    // size hinted elements, they don't depend from the stylesheet
+    QHash<QString, QRectF> interestingElements;
+    bool interestingElementsScanned = false;
+
+private:
+    QList<QByteArray> m_parts;
+};
+
 class SharedSvgRenderer : public QSvgRenderer, public QSharedData
 {
     Q_OBJECT
@@ -27,32 +49,71 @@ public:
 
     explicit SharedSvgRenderer(QObject *parent = nullptr);
     SharedSvgRenderer(
-        const QString &filename,
-        const QString &styleSheet,
-        QHash<QString, QRectF> &interestingElements,
-        QObject *parent = nullptr);
-
-    SharedSvgRenderer(
-        const QByteArray &contents,
+        const SvgSource::Ptr &source,
         const QString &styleSheet,
-        QHash<QString, QRectF> &interestingElements,
         QObject *parent = nullptr);
 
 private:
     bool load(
-        const QByteArray &contents,
-        const QString &styleSheet,
-        QHash<QString, QRectF> &interestingElements);
+        const SvgSource::Ptr &source,
+        const QString &styleSheet);
+
+    SvgSource::Ptr m_source;
 };
 
+// Maps the paths of the svg files used in the cache lookups to small integer
+// ids, remembering their hash so it's not computed on every lookup. Only file
+// paths get in, never element ids, so it's bounded by the svg files the
+// process loads and is never shrunk
+class SvgStringTable
+{
+public:
+    static uint intern(const QString &string);
+    static QString string(uint id);
+    // same value as qHash() of the string
+    static uint hash(uint id);
+};
+
+// qHash() of an element id, as stored in a CacheId
+inline uint svgElementHash(const QString &elementId)
+{
+    return ::qHash(elementId);
+}
+
+// Remembers a value derived from a string and derives it again only when
+// given a different string: the string is kept alive, so comparing the data
+// pointers is enough to tell
+template<uint (*derive)(const QString &)>
+class SvgStringMemo
+{
+public:
+    uint value(const QString &string) const
+    {
+        if (string.constData() != m_string.constData()) {
+            m_string = string;
+            m_value = derive(string);
+        }
+        return m_value;
+    }
+
+private:
+    mutable QString m_string;
+    mutable uint m_value = derive(QString());
+};
+
+// a file path and its id in SvgStringTable
+typedef SvgStringMemo<&SvgStringTable::intern> SvgPathId;
+// an element id and its hash
+typedef SvgStringMemo<&svgElementHash> SvgElementHash;
+
 class SvgPrivate
 {
 public:
     struct CacheId {
         double width;
         double height;
-        QString filePath;
-        QString elementName;
+        uint filePath; // interned with SvgStringTable
+        uint elementName; // svgElementHash() of the element id
         int status;
         double devicePixelRatio;
         double scaleFactor;
@@ -66,9 +127,15 @@ public:
 
     //This function is meant for the rects cache
     CacheId cacheId(const QString &elementId) const;
+    CacheId cacheId(uint elementHash) const;
+
+    //interned id of the current path
+    uint pathId() const;
 
     //This function is meant for the pixmap cache
-    QString cachePath(const QString &path, const QSize &size) const;
+    QString cachePath(uint elementHash, const QSize &size);
+    // the hash of the colors the renderings depend on, 0 when they don't use the color scheme
+    uint colorsHash();
 
     bool setImagePath(const QString &imagePath);
 
@@ -76,14 +143,22 @@ public:
     Theme *cacheAndColorsTheme();
 
     QPixmap findInCache(const QString &elementId, qreal ratio, const QSizeF &s = QSizeF());
+    // same as findInCache, but renders straight into an image and keeps it in memory
+    QImage findImageInCache(const QString &elementId, qreal ratio, const QSizeF &s = QSizeF());
+    // size in device pixels of a rendering, and the size hinted element to render for it
+    QSize renderSize(const QString &elementId, qreal ratio, const QSizeF &s, QString &actualElementId);
+    void render(QPaintDevice *device, const QString &actualElementId, const QSize &size);
+    // a new rendering, with the colors applied if the svg asks for it
+    QImage renderImage(const QString &actualElementId, const QSize &size, qreal ratio);
 
     void createRenderer();
     void eraseRenderer();
 
     QRectF elementRect(const QString &elementId);
-    QRectF findAndCacheElementRect(const QString &elementId);
+    QRectF findAndCacheElementRect(const QString &elementId, const CacheId &cacheId);
 
     void checkColorHints();
+    void checkColorDependency(const SvgSource::Ptr &source);
 
     //Following two are utility functions to snap rendered elements to the pixel grid
     //to and from are always 0 <= val <= 1
@@ -96,6 +171,7 @@ public:
     void colorsChanged();
 
     static QHash<QString, SharedSvgRenderer::Ptr> s_renderers;
+    static QHash<QString, SvgSource::Ptr> s_sources;
     static QPointer<Theme> s_systemColorsCache;
     static qreal s_lastScaleFactor;
 
@@ -112,12 +188,16 @@ public:
     qreal devicePixelRatio;
     qreal scaleFactor;
     Svg::Status status;
+    SvgPathId internedPath;
     bool multipleImages : 1;
     bool themed : 1;
     bool useSystemColors : 1;
     bool fromCurrentTheme : 1;
     bool applyColors : 1;
     bool usesColors : 1;
+    // whether the stylesheet or the colorizing change the renderings; assumed
+    // for files whose source wasn't read yet, unless a previous run recorded it
+    bool dependsOnColors : 1;
     bool cacheRendering : 1;
     bool themeFailed : 1;
 };
@@ -143,6 +223,10 @@ public:
     void setNaturalSize(const QString &path, qreal scaleFactor, const QSizeF &size);
     QSizeF naturalSize(const QString &path, qreal scaleFactor);
 
+    // whether the file has a current-color-scheme stylesheet, as seen the last time it was read
+    void setUsesColorScheme(const QString &path, bool uses);
+    bool usesColorScheme(const QString &path, bool defaultValue);
+
     QList<QSize> sizeHintsForId(const QString &path, const QString &id);
     void insertSizeHintForId(const QString &path, const QString &id, const QSize &size);
 
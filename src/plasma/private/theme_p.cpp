@@ -12,16 +12,27 @@
 #include "debug_p.h"
 
 #include <QGuiApplication>
+#include <QCryptographicHash>
 #include <QFile>
 #include <QFileInfo>
 #include <QFontDatabase>
 #include <QDir>
+#include <QDirIterator>
+#include <QImage>
+#include <QSaveFile>
+#include <QSet>
+#include <QVarLengthArray>
 
 #include <KDirWatch>
 #include <KWindowEffects>
 #include <KIconLoader>
 #include <KIconTheme>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
 namespace Plasma
 {
 
@@ -71,6 +82,8 @@ ThemePrivate::ThemePrivate(QObject *parent)
     ThemeConfig config;
     cacheTheme = config.cacheTheme();
 
+    imageCache.setMemoryBudget(qint64(config.themeMemoryCacheKb()) * 1024);
+
     pixmapSaveTimer = new QTimer(this);
     pixmapSaveTimer->setSingleShot(true);
     pixmapSaveTimer->setInterval(600);
@@ -81,6 +94,15 @@ ThemePrivate::ThemePrivate(QObject *parent)
     updateNotificationTimer->setInterval(100);
     QObject::connect(updateNotificationTimer, &QTimer::timeout, this, &ThemePrivate::notifyOfChanged);
 
+    // palette changes tend to arrive in bursts, one for every top level window:
+    // rebuild the colors only once per frame
+    colorsChangeTimer = new QTimer(this);
+    colorsChangeTimer->setSingleShot(true);
+    colorsChangeTimer->setInterval(16);
+    QObject::connect(colorsChangeTimer, &QTimer::timeout, this, &ThemePrivate::colorsChanged);
+
+    rebuildColorTable();
+
     if (QPixmap::defaultDepth() > 8) {
 #if HAVE_X11
         //watch for background contrast effect property changes as well
@@ -91,7 +113,8 @@ ThemePrivate::ThemePrivate(QObject *parent)
         QObject::connect(s_backgroundContrastEffectWatcher, &EffectWatcher::effectChanged, this, [this](bool active) {
             if (backgroundContrastActive != active) {
                 backgroundContrastActive = active;
-                scheduleThemeChangeNotification(PixmapCache | SvgElementsCache);
+                // the images of each variant have their own paths, so their renderings stay valid
+                scheduleThemeChangeNotification(PublicApiCache);
             }
         });
 #endif
@@ -117,6 +140,7 @@ ThemePrivate::ThemePrivate(QObject *parent)
 ThemePrivate::~ThemePrivate()
 {
     FrameSvgPrivate::s_sharedFrames.remove(this);
+    imageCache.setSharedCache(nullptr);
     delete pixmapCache;
 }
 
@@ -167,19 +191,14 @@ bool ThemePrivate::useCache()
             }
 
             Q_ASSERT(!themeMetadataPath.isEmpty() || themeName.isEmpty());
-            const QString cacheFileBase = cacheFile + QLatin1String("*.kcache");
 
-            QString currentCacheFileName;
             if (!themeMetadataPath.isEmpty()) {
-                // now we record the theme version, if we can
+                // now we record the theme version, if we can; the cache doesn't depend on it,
+                // only the renderings of the files a new version changes are out of date
                 const KPluginInfo pluginInfo(themeMetadataPath);
                 if (pluginInfo.isValid()) {
                     themeVersion = pluginInfo.version();
                 }
-                if (!themeVersion.isEmpty()) {
-                    cacheFile += QLatin1String("_v") + themeVersion;
-                    currentCacheFileName = cacheFile + QLatin1String(".kcache");
-                }
 
                 // watch the metadata file for changes at runtime
                 KDirWatch::self()->addFile(themeMetadataPath);
@@ -196,29 +215,25 @@ bool ThemePrivate::useCache()
             }
 
 
-            // now we check for, and remove if necessary, old caches
+            // now we remove the caches of older releases, which had one per theme version
             QDir cacheDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation));
-            cacheDir.setNameFilters(QStringList({cacheFileBase}));
+            cacheDir.setNameFilters(QStringList({cacheFile + QLatin1String("_v*.kcache")}));
 
             const auto files = cacheDir.entryInfoList();
             for (const QFileInfo &file : files) {
-                if (currentCacheFileName.isEmpty() ||
-                        !file.absoluteFilePath().endsWith(currentCacheFileName)) {
-                    QFile::remove(file.absoluteFilePath());
-                }
+                QFile::remove(file.absoluteFilePath());
             }
 
         }
 
-        // now we do a sanity check: if the metadata.desktop file is newer than the cache, drop the cache
+        // now we do a sanity check: if the metadata.desktop file is newer than the cache, look for the images again
         if (isRegularTheme && !themeMetadataPath.isEmpty()) {
             // now we check to see if the theme metadata file itself is newer than the pixmap cache
             // this is done before creating the pixmapCache object since that can change the mtime
             // on the cache file
 
-            // FIXME: when using the system colors, if they change while the application is not running
-            // the cache should be dropped; we need a way to detect system color change when the
-            // application is not running.
+            // the colors, which may have changed while the application was not running,
+            // are part of the keys of the renderings using them
             // check for expired cache
             const QString cacheFilePath = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1Char('/') + cacheFile + QLatin1String(".kcache");
             if (!cacheFilePath.isEmpty()) {
@@ -231,13 +246,15 @@ bool ThemePrivate::useCache()
             }
         }
 
-        ThemeConfig config;
-        pixmapCache = new KImageCache(cacheFile, config.themeCacheKb() * 1024);
-        pixmapCache->setEvictionPolicy(KSharedDataCache::EvictLeastRecentlyUsed);
-
         if (cachesTooOld) {
-            discardCache(PixmapCache | SvgElementsCache);
+            // the renderings of the files which changed aren't found anymore, as their
+            // keys have the modification time, but the theme may have moved its images
+            discardCache(SvgElementsCache);
         }
+
+        pixmapCache = new KImageCache(cacheFile, cacheSize * 1024);
+        pixmapCache->setEvictionPolicy(KSharedDataCache::EvictLeastRecentlyUsed);
+        imageCache.setSharedCache(pixmapCache);
     }
 
     if (cacheTheme) {
@@ -259,7 +276,9 @@ bool ThemePrivate::useCache()
 
 void ThemePrivate::onAppExitCleanup()
 {
-    pixmapsToCache.clear();
+    imageCache.clearQueue();
+    imageCache.clearMemory();
+    imageCache.setSharedCache(nullptr);
     delete pixmapCache;
     pixmapCache = nullptr;
     cacheTheme = false;
@@ -267,24 +286,33 @@ void ThemePrivate::onAppExitCleanup()
 
 QString ThemePrivate::imagePath(const QString& theme, const QString& type, const QString& image)
 {
-    QString subdir = QLatin1String(PLASMA_RELATIVE_DATA_INSTALL_DIR "/desktoptheme/") % theme % type % image;
-    return QStandardPaths::locate(QStandardPaths::GenericDataLocation, subdir);
+    // type is like "/opaque/", the manifest has paths relative to the theme directory
+    const QString relativePath = type.midRef(1) % image;
+    return themeManifest(theme).value(relativePath);
 }
 
-QString ThemePrivate::findInTheme(const QString &image, const QString &theme, bool cache)
+ThemePrivate::ImageVariant ThemePrivate::imageVariant() const
 {
-    if (cache) {
-        auto it = discoveries.constFind(image);
-        if (it != discoveries.constEnd()) {
-            return it.value();
-        }
+    if (!compositingActive) {
+        return OpaqueImages;
+    } else if (backgroundContrastActive) {
+        return TranslucentImages;
     }
+    return RegularImages;
+}
 
+QString ThemePrivate::findInTheme(const QString &image, const QString &theme)
+{
     QString type = QStringLiteral("/");
-    if (!compositingActive) {
+    switch (imageVariant()) {
+    case OpaqueImages:
         type = QStringLiteral("/opaque/");
-    } else if (backgroundContrastActive) {
+        break;
+    case TranslucentImages:
         type = QStringLiteral("/translucent/");
+        break;
+    case RegularImages:
+        break;
     }
 
     QString search = imagePath(theme, type, image);
@@ -294,11 +322,351 @@ QString ThemePrivate::findInTheme(const QString &image, const QString &theme, bo
         search = imagePath(theme, QStringLiteral("/"), image);
     }
 
-    if (cache && !search.isEmpty()) {
-        discoveries.insert(image, search);
+    return search;
+}
+
+QString ThemePrivate::findImage(const QString &name)
+{
+    // images the theme doesn't have are remembered as well, Svg asks for them over and over
+    QHash<QString, QString> &found = discoveries[imageVariant()];
+    auto it = found.constFind(name);
+    if (it != found.constEnd()) {
+        return it.value();
     }
 
-    return search;
+    // look for a compressed svg file in the theme
+    const QString svgzName = name % QLatin1String(".svgz");
+    QString path = findInTheme(svgzName, themeName);
+
+    if (path.isEmpty()) {
+        // try for an uncompressed svg file
+        const QString svgName = name % QLatin1String(".svg");
+        path = findInTheme(svgName, themeName);
+
+        // search in fallback themes if necessary
+        for (int i = 0; path.isEmpty() && i < fallbackThemes.count(); ++i) {
+            if (themeName == fallbackThemes[i]) {
+                continue;
+            }
+
+            // try a compressed svg file in the fallback theme
+            path = findInTheme(svgzName, fallbackThemes[i]);
+
+            if (path.isEmpty()) {
+                // try an uncompressed svg file in the fallback theme
+                path = findInTheme(svgName, fallbackThemes[i]);
+            }
+        }
+    }
+
+    found.insert(name, path);
+    return path;
+}
+
+// Lists the files of a theme directory, following the symlinked directories.
+// A directory that links back to one being listed is skipped, so it can't loop
+static void addToThemeManifest(QHash<QString, QString> &manifest, const QString &dir, int themeDirLength, QSet<QString> &enteredDirs)
+{
+    const QString canonicalDir = QFileInfo(dir).canonicalFilePath();
+    if (canonicalDir.isEmpty() || enteredDirs.contains(canonicalDir)) {
+        return;
+    }
+    enteredDirs.insert(canonicalDir);
+
+    QDirIterator entries(dir, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    while (entries.hasNext()) {
+        const QString entry = entries.next();
+        if (entries.fileInfo().isDir()) {
+            addToThemeManifest(manifest, entry, themeDirLength, enteredDirs);
+            continue;
+        }
+        const QString relativePath = entry.mid(themeDirLength);
+        if (!manifest.contains(relativePath)) {
+            manifest.insert(relativePath, entry);
+        }
+    }
+
+    enteredDirs.remove(canonicalDir);
+}
+
+const QHash<QString, QString> &ThemePrivate::themeManifest(const QString &theme)
+{
+    auto it = themeManifests.constFind(theme);
+    if (it != themeManifests.constEnd()) {
+        return it.value();
+    }
+
+    watchThemeDirs();
+
+    // the same theme can be in several data directories, a file in the first one
+    // hides the same file in the others, like with QStandardPaths::locate()
+    QHash<QString, QString> manifest;
+    const QStringList themeDirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation,
+                                                            QLatin1String(PLASMA_RELATIVE_DATA_INSTALL_DIR "/desktoptheme/") % theme,
+                                                            QStandardPaths::LocateDirectory);
+    for (const QString &themeDir : themeDirs) {
+        QSet<QString> enteredDirs;
+        addToThemeManifest(manifest, themeDir, themeDir.length() + 1, enteredDirs);
+
+        // the theme being updated: installing a theme replaces its directory
+        // or rewrites its metadata. Watching each of its subdirectories as well
+        // would cost every process an inotify watch per directory of the theme
+        KDirWatch::self()->addDir(themeDir);
+        KDirWatch::self()->addFile(themeDir + QLatin1String("/metadata.desktop"));
+        KDirWatch::self()->addFile(themeDir + QLatin1String("/colors"));
+    }
+
+    return themeManifests.insert(theme, manifest).value();
+}
+
+void ThemePrivate::watchThemeDirs()
+{
+    if (watchingThemeDirs) {
+        return;
+    }
+
+    // themes and wallpaper packages being installed or removed
+    watchingThemeDirs = true;
+    const QStringList dataDirs = QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation);
+    for (const QString &dataDir : dataDirs) {
+        KDirWatch::self()->addDir(dataDir + QLatin1String("/" PLASMA_RELATIVE_DATA_INSTALL_DIR "/desktoptheme"));
+        KDirWatch::self()->addDir(dataDir + QLatin1String("/wallpapers"));
+    }
+    // created and dirty go through settingsFileChanged()
+    connect(KDirWatch::self(), &KDirWatch::deleted, this, [this](const QString &path) {
+        if (isThemeDataPath(path)) {
+            invalidateThemeManifests();
+        }
+    });
+}
+
+// true if path is dir or something in it
+static bool isInDir(const QString &path, const QString &dir)
+{
+    return path.startsWith(dir) && (path.length() == dir.length() || path.at(dir.length()) == QLatin1Char('/'));
+}
+
+bool ThemePrivate::isThemeDataPath(const QString &path)
+{
+    // only the themes and the wallpapers of the data directories, not any
+    // path that happens to have a "wallpapers" in it
+    const QStringList dataDirs = QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation);
+    for (const QString &dataDir : dataDirs) {
+        if (isInDir(path, dataDir + QLatin1String("/" PLASMA_RELATIVE_DATA_INSTALL_DIR "/desktoptheme"))
+            || isInDir(path, dataDir + QLatin1String("/wallpapers"))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThemePrivate::invalidateThemeManifests()
+{
+    themeManifests.clear();
+    for (auto &found : discoveries) {
+        found.clear();
+    }
+    for (auto &wallpapers : themeWallpapers) {
+        wallpapers.clear();
+    }
+    installedWallpapers.clear();
+}
+
+// wallpaper images are named after their size, like 1920x1080.png
+static QSize wallpaperImageSize(const QStringRef &fileName, const QString &suffix)
+{
+    if (!fileName.endsWith(suffix)) {
+        return QSize();
+    }
+
+    const QStringRef name = fileName.left(fileName.length() - suffix.length());
+    const int separator = name.indexOf(QLatin1Char('x'));
+    if (separator < 0) {
+        return QSize();
+    }
+
+    bool widthOk = false;
+    bool heightOk = false;
+    const int width = name.left(separator).toInt(&widthOk);
+    const int height = name.mid(separator + 1).toInt(&heightOk);
+    if (!widthOk || !heightOk || width <= 0 || height <= 0) {
+        return QSize();
+    }
+    return QSize(width, height);
+}
+
+static bool containsWallpaperSize(const QVector<ThemePrivate::WallpaperImage> &images, const QSize &size)
+{
+    return std::any_of(images.cbegin(), images.cend(), [&size](const ThemePrivate::WallpaperImage &image) {
+        return image.size == size;
+    });
+}
+
+QString ThemePrivate::findWallpaper(const QSize &size)
+{
+    const QSize wanted = size.isEmpty() ? QSize(defaultWallpaperWidth, defaultWallpaperHeight) : size;
+
+    //TODO: the theme's wallpaper overrides regularly installed wallpapers.
+    //      should it be possible for user installed (e.g. locateLocal) wallpapers
+    //      to override the theme?
+    const WallpaperImage *image = nullptr;
+    if (hasWallpapers) {
+        image = bestWallpaper(themeWallpaperImages(defaultWallpaperTheme), wanted);
+    }
+
+    if (!image) {
+        image = bestWallpaper(installedWallpaperImages(defaultWallpaperTheme), wanted);
+    }
+
+    if (!image) {
+#ifndef NDEBUG
+        // qCDebug(LOG_PLASMA) << "exhausted every effort to find a wallpaper.";
+#endif
+        return QString();
+    }
+
+    if (config().readEntry("scaleWallpapers", false)) {
+        return scaledWallpaper(*image, wanted);
+    }
+    return image->path;
+}
+
+const QVector<ThemePrivate::WallpaperImage> &ThemePrivate::themeWallpaperImages(const QString &package)
+{
+    QHash<QString, QVector<WallpaperImage>> &indexes = themeWallpapers[imageVariant()];
+    const QString key = package % QLatin1Char('/') % defaultWallpaperSuffix;
+    auto it = indexes.constFind(key);
+    if (it != indexes.constEnd()) {
+        return it.value();
+    }
+
+    QString type;
+    switch (imageVariant()) {
+    case OpaqueImages:
+        type = QStringLiteral("opaque/");
+        break;
+    case TranslucentImages:
+        type = QStringLiteral("translucent/");
+        break;
+    case RegularImages:
+        break;
+    }
+
+    const QHash<QString, QString> &manifest = themeManifest(themeName);
+    const QString imagesPath = QLatin1String("wallpapers/") % package % QLatin1String("/contents/images/");
+    QVector<WallpaperImage> images;
+
+    // like findInTheme(), an image of the variant hides the regular one of the same size
+    auto collect = [&](const QString &prefix) {
+        for (auto file = manifest.constBegin(); file != manifest.constEnd(); ++file) {
+            if (!file.key().startsWith(prefix)) {
+                continue;
+            }
+            const QStringRef fileName = file.key().midRef(prefix.length());
+            if (fileName.contains(QLatin1Char('/'))) {
+                continue;
+            }
+            const QSize size = wallpaperImageSize(fileName, defaultWallpaperSuffix);
+            if (size.isValid() && !containsWallpaperSize(images, size)) {
+                images.append({size, file.value()});
+            }
+        }
+    };
+
+    if (!type.isEmpty()) {
+        collect(type % imagesPath);
+    }
+    collect(imagesPath);
+
+    return indexes.insert(key, images).value();
+}
+
+const QVector<ThemePrivate::WallpaperImage> &ThemePrivate::installedWallpaperImages(const QString &package)
+{
+    const QString key = package % QLatin1Char('/') % defaultWallpaperSuffix;
+    auto it = installedWallpapers.constFind(key);
+    if (it != installedWallpapers.constEnd()) {
+        return it.value();
+    }
+
+    watchThemeDirs();
+
+    // an image in the first data directory hides the one of the same size in the others
+    QVector<WallpaperImage> images;
+    const QStringList imageDirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation,
+                                                            QLatin1String("wallpapers/") % package % QLatin1String("/contents/images"),
+                                                            QStandardPaths::LocateDirectory);
+    for (const QString &imageDir : imageDirs) {
+        QDirIterator files(imageDir, QDir::Files);
+        while (files.hasNext()) {
+            const QString file = files.next();
+            const QSize size = wallpaperImageSize(file.midRef(imageDir.length() + 1), defaultWallpaperSuffix);
+            if (size.isValid() && !containsWallpaperSize(images, size)) {
+                images.append({size, file});
+            }
+        }
+
+        // sizes being added or removed
+        KDirWatch::self()->addDir(imageDir);
+    }
+
+    return installedWallpapers.insert(key, images).value();
+}
+
+const ThemePrivate::WallpaperImage *ThemePrivate::bestWallpaper(const QVector<WallpaperImage> &images, const QSize &size)
+{
+    const WallpaperImage *best = nullptr;
+    qreal bestCost = std::numeric_limits<qreal>::max();
+    const qreal aspectRatio = qreal(size.width()) / size.height();
+    const qreal area = qreal(size.width()) * size.height();
+
+    for (const WallpaperImage &image : images) {
+        // a different aspect ratio means cropping or borders, worse than any scaling
+        const qreal aspectCost = std::abs(std::log(qreal(image.size.width()) / image.size.height() / aspectRatio));
+        // upscaling blurs the image, downscaling only costs some decoding
+        const qreal areaCost = std::log(qreal(image.size.width()) * image.size.height() / area);
+        const qreal cost = 4 * aspectCost + (areaCost < 0 ? -2 * areaCost : areaCost);
+        if (cost < bestCost) {
+            best = &image;
+            bestCost = cost;
+        }
+    }
+
+    return best;
+}
+
+QString ThemePrivate::scaledWallpaper(const WallpaperImage &image, const QSize &size)
+{
+    // only images bigger than the screen in both directions are worth a smaller copy
+    const QSize target = image.size.scaled(size, Qt::KeepAspectRatioByExpanding);
+    if (target.width() >= image.size.width() || target.height() >= image.size.height()) {
+        return image.path;
+    }
+
+    const QFileInfo source(image.path);
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/plasma-wallpapers/");
+    const QString cachePath = cacheDir
+        % QString::fromLatin1(QCryptographicHash::hash(image.path.toUtf8(), QCryptographicHash::Md5).toHex())
+        % QLatin1Char('_') % QString::number(target.width()) % QLatin1Char('x') % QString::number(target.height())
+        % QLatin1Char('.') % source.suffix();
+
+    const QFileInfo cached(cachePath);
+    if (cached.exists() && cached.lastModified() >= source.lastModified()) {
+        return cachePath;
+    }
+
+    const QImage scaled = QImage(image.path).scaled(target, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (scaled.isNull() || !QDir().mkpath(cacheDir)) {
+        return image.path;
+    }
+
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly) || !scaled.save(&file, source.suffix().toLatin1().constData()) || !file.commit()) {
+        qCWarning(LOG_PLASMA) << "Could not cache a scaled copy of" << image.path;
+        return image.path;
+    }
+
+    return cachePath;
 }
 
 void ThemePrivate::compositingChanged(bool active)
@@ -307,21 +675,87 @@ void ThemePrivate::compositingChanged(bool active)
     if (compositingActive != active) {
         compositingActive = active;
         //qCDebug(LOG_PLASMA) << QTime::currentTime();
-        scheduleThemeChangeNotification(PixmapCache | SvgElementsCache);
+        // the images of each variant have their own paths, so their renderings stay valid
+        scheduleThemeChangeNotification(PublicApiCache);
     }
 #endif
 }
 
+bool ThemePrivate::findInCache(const QString &key, QImage &image, unsigned int lastModified,
+                               const QString &path, const QString &element, qreal devicePixelRatio, bool dependsOnColors)
+{
+    // the memory tier is there even when the theme isn't cached on disk
+    const bool shared = useCache() && lastModified <= uint(imageCache.sharedLastModified().toSecsSinceEpoch());
+    return imageCache.find(key, path, element, &image, shared, devicePixelRatio, dependsOnColors);
+}
+
+bool ThemePrivate::findInCache(const QString &key, QPixmap &pixmap, unsigned int lastModified,
+                               const QString &path, const QString &element, qreal devicePixelRatio, bool dependsOnColors)
+{
+    const bool shared = useCache() && lastModified <= uint(imageCache.sharedLastModified().toSecsSinceEpoch());
+    return imageCache.findPixmap(key, path, element, &pixmap, shared, devicePixelRatio, dependsOnColors);
+}
+
+void ThemePrivate::insertIntoCache(const QString &key, const QImage &image, const QString &id,
+                                   const QString &path, const QString &element, bool dependsOnColors, const QPixmap &pixmap)
+{
+    imageCache.insert(key, image, path, element, dependsOnColors, pixmap);
+
+    if (useCache()) {
+        imageCache.enqueue(id, key, image);
+
+        //always start timer in pixmapSaveTimer's thread
+        QMetaObject::invokeMethod(pixmapSaveTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+QString ThemePrivate::publicCacheKey(const QString &key)
+{
+    const uint state[] = {colorTable()->hash, publicCacheGeneration, uint(compositingActive), uint(backgroundContrastActive)};
+    return key % QLatin1Char('_') % QString::number(qHashRange(std::begin(state), std::end(state), SvgRectsCache::s_seed));
+}
+
+void ThemePrivate::insertIntoPublicCache(const QString &key, const QPixmap &pixmap, const QString &id)
+{
+    const QString cacheKey = publicCacheKey(key);
+    publicCacheKeys.insert(cacheKey);
+    // the disk cache only takes images, the pixmap itself is handed out from memory
+    insertIntoCache(cacheKey, pixmap.toImage(), id, QString(), QString(), true, pixmap);
+}
+
 void ThemePrivate::discardCache(CacheTypes caches)
 {
+    // The keys of the renderings have the path and the modification time of
+    // their file, and the colors for those using them: when only some files
+    // or the colors change the other renderings remain valid, the stale ones
+    // just can't be found anymore and make room for new ones in time
     if (caches & PixmapCache) {
-        pixmapsToCache.clear();
+        imageCache.clearMemory();
+        imageCache.clearQueue();
         pixmapSaveTimer->stop();
-        if (pixmapCache) {
-            pixmapCache->clear();
-        }
+        imageCache.clearShared();
     } else {
+        if (caches & ColorDependentCache) {
+            // still written to disk, in case these colors come back
+            imageCache.clearColorDependent();
+        }
+        if (caches & PublicApiCache) {
+            // nothing tells what these depend on, they go as the whole cache used to
+            for (const QString &key : qAsConst(publicCacheKeys)) {
+                imageCache.discard(key);
+            }
+        }
+    }
+
+    if (caches & (PixmapCache | PublicApiCache)) {
+        // the ones already on disk can't be found with the new keys
+        publicCacheKeys.clear();
+        ++publicCacheGeneration;
+    }
+
+    if ((caches & SvgElementsCache) && !(caches & PixmapCache)) {
         // This deletes the object but keeps the on-disk cache for later use
+        imageCache.setSharedCache(nullptr);
         delete pixmapCache;
         pixmapCache = nullptr;
     }
@@ -331,23 +765,21 @@ void ThemePrivate::discardCache(CacheTypes caches)
     cachedSelectedSvgStyleSheets.clear();
 
     if (caches & SvgElementsCache) {
-        discoveries.clear();
+        for (auto &found : discoveries) {
+            found.clear();
+        }
+        // the svgs of the old theme are gone for good, don't keep their margins around
+        FrameSvgPrivate::s_frameGeometries.clear();
     }
 }
 
 void ThemePrivate::scheduledCacheUpdate()
 {
     if (useCache()) {
-        QHashIterator<QString, QPixmap> it(pixmapsToCache);
-        while (it.hasNext()) {
-            it.next();
-            pixmapCache->insertPixmap(idsToCache[it.key()], it.value());
-        }
+        imageCache.flushQueue();
+    } else {
+        imageCache.clearQueue();
     }
-
-    pixmapsToCache.clear();
-    keysToCache.clear();
-    idsToCache.clear();
 }
 
 void ThemePrivate::colorsChanged()
@@ -357,16 +789,27 @@ void ThemePrivate::colorsChanged()
     if (!colors) {
         KSharedConfig::openConfig()->reparseConfiguration();
     }
+    updateColorSchemes();
+    rebuildColorTable();
+    scheduleThemeChangeNotification(ColorDependentCache | PublicApiCache);
+    Q_EMIT applicationPaletteChange();
+}
+
+void ThemePrivate::scheduleColorsChange()
+{
+    colorsChangeTimer->start();
+}
+
+void ThemePrivate::updateColorSchemes()
+{
     colorScheme = KColorScheme(QPalette::Active, KColorScheme::Window, colors);
+    selectionColorScheme = KColorScheme(QPalette::Active, KColorScheme::Selection, colors);
     buttonColorScheme = KColorScheme(QPalette::Active, KColorScheme::Button, colors);
     viewColorScheme = KColorScheme(QPalette::Active, KColorScheme::View, colors);
-    selectionColorScheme = KColorScheme(QPalette::Active, KColorScheme::Selection, colors);
     complementaryColorScheme = KColorScheme(QPalette::Active, KColorScheme::Complementary, colors);
     headerColorScheme = KColorScheme(QPalette::Active, KColorScheme::Header, colors);
     tooltipColorScheme = KColorScheme(QPalette::Active, KColorScheme::Tooltip, colors);
     palette = KColorScheme::createApplicationPalette(colors);
-    scheduleThemeChangeNotification(PixmapCache | SvgElementsCache);
-    Q_EMIT applicationPaletteChange();
 }
 
 void ThemePrivate::scheduleThemeChangeNotification(CacheTypes caches)
@@ -408,65 +851,68 @@ const QString ThemePrivate::processStyleSheet(const QString &css, Plasma::Svg::S
         stylesheet = css;
     }
 
+    // all the colors come from the same snapshot, even if the scheme changes meanwhile
+    const std::shared_ptr<const ColorTable> table = colorTable();
+
     QHash<QString, QString> elements;
     // If you add elements here, make sure their names are sufficiently unique to not cause
     // clashes between element keys
-    elements[QStringLiteral("%textcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightedTextColor : Theme::TextColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%backgroundcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightColor : Theme::BackgroundColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%highlightcolor")] = color(Theme::HighlightColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%highlightedtextcolor")] = color(Theme::HighlightedTextColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%visitedlink")] = color(Theme::VisitedLinkColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%activatedlink")] = color(Theme::HighlightColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%hoveredlink")] = color(Theme::HighlightColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%link")] = color(Theme::LinkColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%positivetextcolor")] = color(Theme::PositiveTextColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%neutraltextcolor")] = color(Theme::NeutralTextColor, Theme::NormalColorGroup).name();
-    elements[QStringLiteral("%negativetextcolor")] = color(Theme::NegativeTextColor, Theme::NormalColorGroup).name();
-
-    elements[QStringLiteral("%buttontextcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightedTextColor : Theme::TextColor, Theme::ButtonColorGroup).name();
-    elements[QStringLiteral("%buttonbackgroundcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightColor : Theme::BackgroundColor, Theme::ButtonColorGroup).name();
-    elements[QStringLiteral("%buttonhovercolor")] = color(Theme::HoverColor, Theme::ButtonColorGroup).name();
-    elements[QStringLiteral("%buttonfocuscolor")] = color(Theme::FocusColor, Theme::ButtonColorGroup).name();
-    elements[QStringLiteral("%buttonhighlightedtextcolor")] = color(Theme::HighlightedTextColor, Theme::ButtonColorGroup).name();
-    elements[QStringLiteral("%buttonpositivetextcolor")] = color(Theme::PositiveTextColor, Theme::ButtonColorGroup).name();
-    elements[QStringLiteral("%buttonneutraltextcolor")] = color(Theme::NeutralTextColor, Theme::ButtonColorGroup).name();
-    elements[QStringLiteral("%buttonnegativetextcolor")] = color(Theme::NegativeTextColor, Theme::ButtonColorGroup).name();
-
-    elements[QStringLiteral("%viewtextcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightedTextColor : Theme::TextColor, Theme::ViewColorGroup).name();
-    elements[QStringLiteral("%viewbackgroundcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightColor : Theme::BackgroundColor, Theme::ViewColorGroup).name();
-    elements[QStringLiteral("%viewhovercolor")] = color(Theme::HoverColor, Theme::ViewColorGroup).name();
-    elements[QStringLiteral("%viewfocuscolor")] = color(Theme::FocusColor, Theme::ViewColorGroup).name();
-    elements[QStringLiteral("%viewhighlightedtextcolor")] = color(Theme::HighlightedTextColor, Theme::ViewColorGroup).name();
-    elements[QStringLiteral("%viewpositivetextcolor")] = color(Theme::PositiveTextColor, Theme::ViewColorGroup).name();
-    elements[QStringLiteral("%viewneutraltextcolor")] = color(Theme::NeutralTextColor, Theme::ViewColorGroup).name();
-    elements[QStringLiteral("%viewnegativetextcolor")] = color(Theme::NegativeTextColor, Theme::ViewColorGroup).name();
+    elements[QStringLiteral("%textcolor")] = table->color(Theme::TextColor, Theme::NormalColorGroup, status).name();
+    elements[QStringLiteral("%backgroundcolor")] = table->color(Theme::BackgroundColor, Theme::NormalColorGroup, status).name();
+    elements[QStringLiteral("%highlightcolor")] = table->color(Theme::HighlightColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%highlightedtextcolor")] = table->color(Theme::HighlightedTextColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%visitedlink")] = table->color(Theme::VisitedLinkColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%activatedlink")] = table->color(Theme::HighlightColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%hoveredlink")] = table->color(Theme::HighlightColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%link")] = table->color(Theme::LinkColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%positivetextcolor")] = table->color(Theme::PositiveTextColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%neutraltextcolor")] = table->color(Theme::NeutralTextColor, Theme::NormalColorGroup).name();
+    elements[QStringLiteral("%negativetextcolor")] = table->color(Theme::NegativeTextColor, Theme::NormalColorGroup).name();
+
+    elements[QStringLiteral("%buttontextcolor")] = table->color(Theme::TextColor, Theme::ButtonColorGroup, status).name();
+    elements[QStringLiteral("%buttonbackgroundcolor")] = table->color(Theme::BackgroundColor, Theme::ButtonColorGroup, status).name();
+    elements[QStringLiteral("%buttonhovercolor")] = table->color(Theme::HoverColor, Theme::ButtonColorGroup).name();
+    elements[QStringLiteral("%buttonfocuscolor")] = table->color(Theme::FocusColor, Theme::ButtonColorGroup).name();
+    elements[QStringLiteral("%buttonhighlightedtextcolor")] = table->color(Theme::HighlightedTextColor, Theme::ButtonColorGroup).name();
+    elements[QStringLiteral("%buttonpositivetextcolor")] = table->color(Theme::PositiveTextColor, Theme::ButtonColorGroup).name();
+    elements[QStringLiteral("%buttonneutraltextcolor")] = table->color(Theme::NeutralTextColor, Theme::ButtonColorGroup).name();
+    elements[QStringLiteral("%buttonnegativetextcolor")] = table->color(Theme::NegativeTextColor, Theme::ButtonColorGroup).name();
+
+    elements[QStringLiteral("%viewtextcolor")] = table->color(Theme::TextColor, Theme::ViewColorGroup, status).name();
+    elements[QStringLiteral("%viewbackgroundcolor")] = table->color(Theme::BackgroundColor, Theme::ViewColorGroup, status).name();
+    elements[QStringLiteral("%viewhovercolor")] = table->color(Theme::HoverColor, Theme::ViewColorGroup).name();
+    elements[QStringLiteral("%viewfocuscolor")] = table->color(Theme::FocusColor, Theme::ViewColorGroup).name();
+    elements[QStringLiteral("%viewhighlightedtextcolor")] = table->color(Theme::HighlightedTextColor, Theme::ViewColorGroup).name();
+    elements[QStringLiteral("%viewpositivetextcolor")] = table->color(Theme::PositiveTextColor, Theme::ViewColorGroup).name();
+    elements[QStringLiteral("%viewneutraltextcolor")] = table->color(Theme::NeutralTextColor, Theme::ViewColorGroup).name();
+    elements[QStringLiteral("%viewnegativetextcolor")] = table->color(Theme::NegativeTextColor, Theme::ViewColorGroup).name();
     
-    elements[QStringLiteral("%tooltiptextcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightedTextColor : Theme::TextColor, Theme::ToolTipColorGroup).name();
-    elements[QStringLiteral("%tooltipbackgroundcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightColor : Theme::BackgroundColor, Theme::ToolTipColorGroup).name();
-    elements[QStringLiteral("%tooltiphovercolor")] = color(Theme::HoverColor, Theme::ToolTipColorGroup).name();
-    elements[QStringLiteral("%tooltipfocuscolor")] = color(Theme::FocusColor, Theme::ToolTipColorGroup).name();
-    elements[QStringLiteral("%tooltiphighlightedtextcolor")] = color(Theme::HighlightedTextColor, Theme::ToolTipColorGroup).name();
-    elements[QStringLiteral("%tooltippositivetextcolor")] = color(Theme::PositiveTextColor, Theme::ToolTipColorGroup).name();
-    elements[QStringLiteral("%tooltipneutraltextcolor")] = color(Theme::NeutralTextColor, Theme::ToolTipColorGroup).name();
-    elements[QStringLiteral("%tooltipnegativetextcolor")] = color(Theme::NegativeTextColor, Theme::ToolTipColorGroup).name();
-
-    elements[QStringLiteral("%complementarytextcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightedTextColor : Theme::TextColor, Theme::ComplementaryColorGroup).name();
-    elements[QStringLiteral("%complementarybackgroundcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightColor : Theme::BackgroundColor, Theme::ComplementaryColorGroup).name();
-    elements[QStringLiteral("%complementaryhovercolor")] = color(Theme::HoverColor, Theme::ComplementaryColorGroup).name();
-    elements[QStringLiteral("%complementaryfocuscolor")] = color(Theme::FocusColor, Theme::ComplementaryColorGroup).name();
-    elements[QStringLiteral("%complementaryhighlightedtextcolor")] = color(Theme::HighlightedTextColor, Theme::ComplementaryColorGroup).name();
-    elements[QStringLiteral("%complementarypositivetextcolor")] = color(Theme::PositiveTextColor, Theme::ComplementaryColorGroup).name();
-    elements[QStringLiteral("%complementaryneutraltextcolor")] = color(Theme::NeutralTextColor, Theme::ComplementaryColorGroup).name();
-    elements[QStringLiteral("%complementarynegativetextcolor")] = color(Theme::NegativeTextColor, Theme::ComplementaryColorGroup).name();
-
-        elements[QStringLiteral("%headertextcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightedTextColor : Theme::TextColor, Theme::HeaderColorGroup).name();
-    elements[QStringLiteral("%headerbackgroundcolor")] = color(status == Svg::Status::Selected ? Theme::HighlightColor : Theme::BackgroundColor, Theme::HeaderColorGroup).name();
-    elements[QStringLiteral("%headerhovercolor")] = color(Theme::HoverColor, Theme::HeaderColorGroup).name();
-    elements[QStringLiteral("%headerfocuscolor")] = color(Theme::FocusColor, Theme::HeaderColorGroup).name();
-    elements[QStringLiteral("%headerhighlightedtextcolor")] = color(Theme::HighlightedTextColor, Theme::HeaderColorGroup).name();
-    elements[QStringLiteral("%headerpositivetextcolor")] = color(Theme::PositiveTextColor, Theme::HeaderColorGroup).name();
-    elements[QStringLiteral("%headerneutraltextcolor")] = color(Theme::NeutralTextColor, Theme::HeaderColorGroup).name();
-    elements[QStringLiteral("%headernegativetextcolor")] = color(Theme::NegativeTextColor, Theme::HeaderColorGroup).name();
+    elements[QStringLiteral("%tooltiptextcolor")] = table->color(Theme::TextColor, Theme::ToolTipColorGroup, status).name();
+    elements[QStringLiteral("%tooltipbackgroundcolor")] = table->color(Theme::BackgroundColor, Theme::ToolTipColorGroup, status).name();
+    elements[QStringLiteral("%tooltiphovercolor")] = table->color(Theme::HoverColor, Theme::ToolTipColorGroup).name();
+    elements[QStringLiteral("%tooltipfocuscolor")] = table->color(Theme::FocusColor, Theme::ToolTipColorGroup).name();
+    elements[QStringLiteral("%tooltiphighlightedtextcolor")] = table->color(Theme::HighlightedTextColor, Theme::ToolTipColorGroup).name();
+    elements[QStringLiteral("%tooltippositivetextcolor")] = table->color(Theme::PositiveTextColor, Theme::ToolTipColorGroup).name();
+    elements[QStringLiteral("%tooltipneutraltextcolor")] = table->color(Theme::NeutralTextColor, Theme::ToolTipColorGroup).name();
+    elements[QStringLiteral("%tooltipnegativetextcolor")] = table->color(Theme::NegativeTextColor, Theme::ToolTipColorGroup).name();
+
+    elements[QStringLiteral("%complementarytextcolor")] = table->color(Theme::TextColor, Theme::ComplementaryColorGroup, status).name();
+    elements[QStringLiteral("%complementarybackgroundcolor")] = table->color(Theme::BackgroundColor, Theme::ComplementaryColorGroup, status).name();
+    elements[QStringLiteral("%complementaryhovercolor")] = table->color(Theme::HoverColor, Theme::ComplementaryColorGroup).name();
+    elements[QStringLiteral("%complementaryfocuscolor")] = table->color(Theme::FocusColor, Theme::ComplementaryColorGroup).name();
+    elements[QStringLiteral("%complementaryhighlightedtextcolor")] = table->color(Theme::HighlightedTextColor, Theme::ComplementaryColorGroup).name();
+    elements[QStringLiteral("%complementarypositivetextcolor")] = table->color(Theme::PositiveTextColor, Theme::ComplementaryColorGroup).name();
+    elements[QStringLiteral("%complementaryneutraltextcolor")] = table->color(Theme::NeutralTextColor, Theme::ComplementaryColorGroup).name();
+    elements[QStringLiteral("%complementarynegativetextcolor")] = table->color(Theme::NegativeTextColor, Theme::ComplementaryColorGroup).name();
+
+        elements[QStringLiteral("%headertextcolor")] = table->color(Theme::TextColor, Theme::HeaderColorGroup, status).name();
+    elements[QStringLiteral("%headerbackgroundcolor")] = table->color(Theme::BackgroundColor, Theme::HeaderColorGroup, status).name();
+    elements[QStringLiteral("%headerhovercolor")] = table->color(Theme::HoverColor, Theme::HeaderColorGroup).name();
+    elements[QStringLiteral("%headerfocuscolor")] = table->color(Theme::FocusColor, Theme::HeaderColorGroup).name();
+    elements[QStringLiteral("%headerhighlightedtextcolor")] = table->color(Theme::HighlightedTextColor, Theme::HeaderColorGroup).name();
+    elements[QStringLiteral("%headerpositivetextcolor")] = table->color(Theme::PositiveTextColor, Theme::HeaderColorGroup).name();
+    elements[QStringLiteral("%headerneutraltextcolor")] = table->color(Theme::NeutralTextColor, Theme::HeaderColorGroup).name();
+    elements[QStringLiteral("%headernegativetextcolor")] = table->color(Theme::NegativeTextColor, Theme::HeaderColorGroup).name();
 
     QFont font = QGuiApplication::font();
     elements[QStringLiteral("%fontsize")] = QStringLiteral("%1pt").arg(font.pointSize());
@@ -608,6 +1054,10 @@ const QString ThemePrivate::svgStyleSheet(Plasma::Theme::ColorGroup group, Plasm
 void ThemePrivate::settingsFileChanged(const QString &file)
 {
     qCDebug(LOG_PLASMA) << "settingsFile: " << file;
+    if (isThemeDataPath(file)) {
+        invalidateThemeManifests();
+    }
+
     if (file == themeMetadataPath) {
         const KPluginInfo pluginInfo(themeMetadataPath);
         if (!pluginInfo.isValid() || themeVersion != pluginInfo.version()) {
@@ -629,47 +1079,47 @@ void ThemePrivate::settingsChanged(bool emitChanges)
     setThemeName(cg.readEntry("name", ThemePrivate::defaultTheme), false, emitChanges);
 }
 
-QColor ThemePrivate::color(Theme::ColorRole role, Theme::ColorGroup group) const
+static QColor schemeColor(const ThemePrivate *d, Theme::ColorRole role, Theme::ColorGroup group)
 {
     const KColorScheme *scheme = nullptr;
 
     //Before 5.0 Plasma theme really only used Normal and Button
     //many old themes are built on this assumption and will break
     //otherwise
-    if (apiMajor < 5 && group != Theme::NormalColorGroup) {
+    if (d->apiMajor < 5 && group != Theme::NormalColorGroup) {
         group = Theme::ButtonColorGroup;
     }
 
     switch (group) {
     case Theme::ButtonColorGroup: {
-        scheme = &buttonColorScheme;
+        scheme = &d->buttonColorScheme;
         break;
     }
 
     case Theme::ViewColorGroup: {
-        scheme = &viewColorScheme;
+        scheme = &d->viewColorScheme;
         break;
     }
 
     //this doesn't have a real kcolorscheme
     case Theme::ComplementaryColorGroup: {
-        scheme = &complementaryColorScheme;
+        scheme = &d->complementaryColorScheme;
         break;
     }
 
     case Theme::HeaderColorGroup: {
-        scheme = &headerColorScheme;
+        scheme = &d->headerColorScheme;
         break;
     }
     
     case Theme::ToolTipColorGroup: {
-        scheme = &tooltipColorScheme;
+        scheme = &d->tooltipColorScheme;
         break;
     }
 
     case Theme::NormalColorGroup:
     default: {
-        scheme = &colorScheme;
+        scheme = &d->colorScheme;
         break;
     }
     }
@@ -688,7 +1138,7 @@ QColor ThemePrivate::color(Theme::ColorRole role, Theme::ColorGroup group) const
         return scheme->decoration(KColorScheme::HoverColor).color();
 
     case Theme::HighlightColor:
-        return selectionColorScheme.background(KColorScheme::NormalBackground).color();
+        return d->selectionColorScheme.background(KColorScheme::NormalBackground).color();
 
     case Theme::FocusColor:
         return scheme->decoration(KColorScheme::FocusColor).color();
@@ -700,7 +1150,7 @@ QColor ThemePrivate::color(Theme::ColorRole role, Theme::ColorGroup group) const
         return scheme->foreground(KColorScheme::VisitedText).color();
 
     case Theme::HighlightedTextColor:
-        return selectionColorScheme.foreground(KColorScheme::NormalText).color();
+        return d->selectionColorScheme.foreground(KColorScheme::NormalText).color();
 
     case Theme::PositiveTextColor:
         return scheme->foreground(KColorScheme::PositiveText).color();
@@ -715,6 +1165,51 @@ QColor ThemePrivate::color(Theme::ColorRole role, Theme::ColorGroup group) const
     return QColor();
 }
 
+QColor ThemePrivate::color(Theme::ColorRole role, Theme::ColorGroup group) const
+{
+    return colorTable()->color(role, group);
+}
+
+std::shared_ptr<const ColorTable> ThemePrivate::colorTable() const
+{
+    return std::atomic_load(&currentColorTable);
+}
+
+void ThemePrivate::rebuildColorTable()
+{
+    static quint64 s_version = 0;
+
+    auto table = std::make_shared<ColorTable>();
+    table->version = ++s_version;
+    table->legacyColorGroups = apiMajor < 5;
+
+    for (int group = Theme::NormalColorGroup; group <= Theme::ToolTipColorGroup; ++group) {
+        for (int role = Theme::TextColor; role <= Theme::DisabledTextColor; ++role) {
+            const QColor c = schemeColor(this, Theme::ColorRole(role), Theme::ColorGroup(group));
+            table->colors[Svg::Status::Normal][group][role] = c;
+            table->colors[Svg::Status::Selected][group][role] = c;
+        }
+
+        // selected elements swap text and background for the highlight colors
+        QColor (&selected)[Theme::DisabledTextColor + 1] = table->colors[Svg::Status::Selected][group];
+        selected[Theme::TextColor] = selected[Theme::HighlightedTextColor];
+        selected[Theme::BackgroundColor] = selected[Theme::HighlightColor];
+    }
+
+    // the svg stylesheets are made of these colors only
+    QVarLengthArray<QRgb, 256> rgbs;
+    for (const auto &statusColors : table->colors) {
+        for (const auto &groupColors : statusColors) {
+            for (const QColor &color : groupColors) {
+                rgbs.append(color.rgba());
+            }
+        }
+    }
+    table->hash = qHashRange(rgbs.cbegin(), rgbs.cend(), SvgRectsCache::s_seed);
+
+    std::atomic_store(&currentColorTable, std::shared_ptr<const ColorTable>(std::move(table)));
+}
+
 void ThemePrivate::processWallpaperSettings(KConfigBase *metadata)
 {
     if (!defaultWallpaperTheme.isEmpty() && defaultWallpaperTheme != QLatin1String(DEFAULT_WALLPAPER_THEME)) {
@@ -813,16 +1308,12 @@ void ThemePrivate::setThemeName(const QString &tempThemeName, bool writeSettings
         colors = KSharedConfig::openConfig(colorsFile);
     }
 
-    colorScheme = KColorScheme(QPalette::Active, KColorScheme::Window, colors);
-    selectionColorScheme = KColorScheme(QPalette::Active, KColorScheme::Selection, colors);
-    buttonColorScheme = KColorScheme(QPalette::Active, KColorScheme::Button, colors);
-    viewColorScheme = KColorScheme(QPalette::Active, KColorScheme::View, colors);
-    complementaryColorScheme = KColorScheme(QPalette::Active, KColorScheme::Complementary, colors);
-    headerColorScheme = KColorScheme(QPalette::Active, KColorScheme::Header, colors);
-    tooltipColorScheme = KColorScheme(QPalette::Active, KColorScheme::Tooltip, colors);
-    palette = KColorScheme::createApplicationPalette(colors);
+    updateColorSchemes();
     const QString wallpaperPath = QLatin1String(PLASMA_RELATIVE_DATA_INSTALL_DIR "/desktoptheme/") % theme % QLatin1String("/wallpapers/");
     hasWallpapers = !QStandardPaths::locate(QStandardPaths::GenericDataLocation, wallpaperPath, QStandardPaths::LocateDirectory).isEmpty();
+    for (auto &wallpapers : themeWallpapers) {
+        wallpapers.clear();
+    }
 
     // load the wallpaper settings, if any
     if (realTheme) {
@@ -879,6 +1370,9 @@ void ThemePrivate::setThemeName(const QString &tempThemeName, bool writeSettings
         }
     }
 
+    // the api version influences the color groups, so build the table only now
+    rebuildColorTable();
+
     if (realTheme && isDefault && writeSettings) {
         // we're the default theme, let's save our status
         KConfigGroup &cg = config();
@@ -895,7 +1389,7 @@ bool ThemePrivate::eventFilter(QObject *watched, QEvent *event)
 {
     if (watched == QCoreApplication::instance()) {
         if (event->type() == QEvent::ApplicationPaletteChange) {
-            colorsChanged();
+            scheduleColorsChange();
         }
         if (event->type() == QEvent::ApplicationFontChange || event->type() == QEvent::FontChange) {
             Q_EMIT defaultFontChanged();
@@ -10,7 +10,11 @@
 
 #include "theme.h"
 #include "svg.h"
+#include "themeimagecache_p.h"
 #include <QHash>
+#include <QSet>
+#include <QSize>
+#include <QVector>
 
 #include <QDebug>
 #include <KColorScheme>
@@ -20,6 +24,8 @@
 #include <KPluginMetaData>
 #include <QTimer>
 
+#include <memory>
+
 #include <config-plasma.h>
 #if HAVE_X11
 #include "private/effectwatcher_p.h"
@@ -41,11 +47,43 @@ static const int DEFAULT_WALLPAPER_HEIGHT = 1200;
 enum CacheType {
     NoCache = 0,
     PixmapCache = 1,
-    SvgElementsCache = 2
+    SvgElementsCache = 2,
+    // only the renderings which use the colors, kept in memory
+    ColorDependentCache = 4,
+    // the images stored through the public Theme API, which may depend on anything
+    PublicApiCache = 8
 };
 Q_DECLARE_FLAGS(CacheTypes, CacheType)
 Q_DECLARE_OPERATORS_FOR_FLAGS(CacheTypes)
 
+// Immutable snapshot of all the colors a theme provides, built once per
+// color scheme change; readers keep a reference to a snapshot while the
+// theme is free to swap in a new table at any time
+struct ColorTable {
+    const QColor &color(Theme::ColorRole role, Theme::ColorGroup group, Svg::Status status = Svg::Status::Normal) const
+    {
+        static const QColor invalid;
+        if (role < Theme::TextColor || role > Theme::DisabledTextColor) {
+            return invalid;
+        }
+        // unknown groups get the colors of the normal one, or of the
+        // button one for the themes older than 5.0, as the schemes do
+        if (group < Theme::NormalColorGroup || group > Theme::ToolTipColorGroup) {
+            group = legacyColorGroups ? Theme::ButtonColorGroup : Theme::NormalColorGroup;
+        }
+        if (status != Svg::Status::Selected) {
+            status = Svg::Status::Normal;
+        }
+        return colors[status][group][role];
+    }
+
+    quint64 version = 0;
+    bool legacyColorGroups = false;
+    // of all the colors, the same in every process using them
+    uint hash = 0;
+    QColor colors[Svg::Status::Selected + 1][Theme::ToolTipColorGroup + 1][Theme::DisabledTextColor + 1];
+};
+
 class ThemePrivate : public QObject, public QSharedData
 {
     Q_OBJECT
@@ -56,9 +94,49 @@ public:
 
     KConfigGroup &config();
 
+    // the directories of a theme an image is looked for in first
+    enum ImageVariant {
+        RegularImages = 0,
+        OpaqueImages,
+        TranslucentImages,
+    };
+    ImageVariant imageVariant() const;
+
     QString imagePath(const QString &theme, const QString &type, const QString &image);
-    QString findInTheme(const QString &image, const QString &theme, bool cache = true);
+    QString findInTheme(const QString &image, const QString &theme);
+    QString findImage(const QString &name);
+    const QHash<QString, QString> &themeManifest(const QString &theme);
+    void watchThemeDirs();
+    static bool isThemeDataPath(const QString &path);
+    void invalidateThemeManifests();
+
+    // the sizes a wallpaper package comes in
+    struct WallpaperImage {
+        QSize size;
+        QString path;
+    };
+    QString findWallpaper(const QSize &size);
+    const QVector<WallpaperImage> &themeWallpaperImages(const QString &package);
+    const QVector<WallpaperImage> &installedWallpaperImages(const QString &package);
+    static const WallpaperImage *bestWallpaper(const QVector<WallpaperImage> &images, const QSize &size);
+    static QString scaledWallpaper(const WallpaperImage &image, const QSize &size);
     void discardCache(CacheTypes caches);
+    // the cache lookups of Svg and FrameSvg, accounted to the image path and element; the images
+    // depending on the colors are dropped from memory when they change, the others stay
+    bool findInCache(const QString &key, QImage &image, unsigned int lastModified,
+                     const QString &path = QString(), const QString &element = QString(), qreal devicePixelRatio = 1,
+                     bool dependsOnColors = true);
+    // the pixmaps found in memory are converted only once
+    bool findInCache(const QString &key, QPixmap &pixmap, unsigned int lastModified,
+                     const QString &path, const QString &element, qreal devicePixelRatio, bool dependsOnColors);
+    void insertIntoCache(const QString &key, const QImage &image, const QString &id,
+                         const QString &path = QString(), const QString &element = QString(), bool dependsOnColors = true,
+                         const QPixmap &pixmap = QPixmap());
+    // the key of an image stored through the public Theme API: it has the colors,
+    // the compositing and the changes seen so far, so the images stored on disk
+    // before one of them aren't found after it
+    QString publicCacheKey(const QString &key);
+    void insertIntoPublicCache(const QString &key, const QPixmap &pixmap, const QString &id);
     void scheduleThemeChangeNotification(CacheTypes caches);
     bool useCache();
     void setThemeName(const QString &themeName, bool writeSettings, bool emitChanged);
@@ -69,10 +147,14 @@ public:
     const QString processStyleSheet(const QString &css, Plasma::Svg::Status status);
     const QString svgStyleSheet(Plasma::Theme::ColorGroup group, Plasma::Svg::Status status);
     QColor color(Theme::ColorRole role, Theme::ColorGroup group = Theme::NormalColorGroup) const;
+    std::shared_ptr<const ColorTable> colorTable() const;
+    void updateColorSchemes();
+    void rebuildColorTable();
 
 public Q_SLOTS:
     void compositingChanged(bool active);
     void colorsChanged();
+    void scheduleColorsChange();
     void settingsFileChanged(const QString &settings);
     void scheduledCacheUpdate();
     void onAppExitCleanup();
@@ -108,6 +190,7 @@ public:
     KColorScheme headerColorScheme;
     KColorScheme tooltipColorScheme;
     QPalette palette;
+    std::shared_ptr<const ColorTable> currentColorTable;
     bool eventFilter(QObject *watched, QEvent *event) override;
     KConfigGroup cfg;
     QString defaultWallpaperTheme;
@@ -116,14 +199,25 @@ public:
     int defaultWallpaperHeight;
     KImageCache *pixmapCache;
     QString cachedDefaultStyleSheet;
-    QHash<QString, QPixmap> pixmapsToCache;
-    QHash<QString, QString> keysToCache;
-    QHash<QString, QString> idsToCache;
+    // the recently used renderings in memory, in front of pixmapCache
+    ThemeImageCache imageCache;
     QHash<Theme::ColorGroup, QString> cachedSvgStyleSheets;
     QHash<Theme::ColorGroup, QString> cachedSelectedSvgStyleSheets;
-    QHash<QString, QString> discoveries;
+    // what findImage() found, or didn't, for each variant
+    QHash<QString, QString> discoveries[TranslucentImages + 1];
+    // the files of each theme, by path relative to the theme directory
+    QHash<QString, QHash<QString, QString>> themeManifests;
+    bool watchingThemeDirs = false;
+    // the public keys stored in this process, and how many times they got discarded
+    QSet<QString> publicCacheKeys;
+    uint publicCacheGeneration = 0;
+    // the wallpaper sizes in the theme for each variant and in the wallpapers
+    // directories, by package name and file suffix
+    QHash<QString, QVector<WallpaperImage>> themeWallpapers[TranslucentImages + 1];
+    QHash<QString, QVector<WallpaperImage>> installedWallpapers;
     QTimer *pixmapSaveTimer;
     QTimer *updateNotificationTimer;
+    QTimer *colorsChangeTimer;
     unsigned cacheSize;
     CacheTypes cachesToDiscard;
     QString themeVersion;
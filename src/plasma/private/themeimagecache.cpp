@@ -0,0 +1,417 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "themeimagecache_p.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVector>
+
+#include <KImageCache>
+
+namespace Plasma
+{
+
+static const int s_flushBatchSize = 16;
+
+struct ThemeImageCache::Writer {
+    // guards everything but sharedCache
+    QMutex mutex;
+    QHash<QString, QueuedImage> queue;
+    // the id each queued key belongs to
+    QHash<QString, QString> queuedIds;
+    bool running = false;
+    quint64 insertions = 0;
+    quint64 flushes = 0;
+    qint64 lastFlushTime = 0;
+
+    QMutex sharedMutex;
+    KImageCache *sharedCache = nullptr;
+};
+
+class ThemeImageWriter : public QRunnable
+{
+public:
+    explicit ThemeImageWriter(const std::shared_ptr<ThemeImageCache::Writer> &writer)
+        : m_writer(writer)
+    {
+    }
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        while (true) {
+            struct Batched {
+                QString id;
+                ThemeImageCache::QueuedImage queued;
+            };
+            QVector<Batched> batch;
+            {
+                QMutexLocker locker(&m_writer->mutex);
+                if (m_writer->queue.isEmpty()) {
+                    m_writer->running = false;
+                    ++m_writer->flushes;
+                    m_writer->lastFlushTime = timer.elapsed();
+                    return;
+                }
+                batch.reserve(qMin(m_writer->queue.count(), s_flushBatchSize));
+                for (auto it = m_writer->queue.cbegin(); it != m_writer->queue.cend() && batch.count() < s_flushBatchSize; ++it) {
+                    batch.append({it.key(), *it});
+                }
+            }
+
+            // images stay in the queue, where lookups find them, until they are in the shared cache
+            quint64 inserted = 0;
+            {
+                QMutexLocker locker(&m_writer->sharedMutex);
+                if (m_writer->sharedCache) {
+                    for (const Batched &batched : qAsConst(batch)) {
+                        if (m_writer->sharedCache->insertImage(batched.queued.key, batched.queued.image)) {
+                            ++inserted;
+                        }
+                    }
+                }
+            }
+
+            QMutexLocker locker(&m_writer->mutex);
+            m_writer->insertions += inserted;
+            for (const Batched &batched : qAsConst(batch)) {
+                // unless they got replaced in the meantime
+                auto it = m_writer->queue.find(batched.id);
+                if (it != m_writer->queue.end() && it->key == batched.queued.key
+                    && it->image.cacheKey() == batched.queued.image.cacheKey()) {
+                    m_writer->queuedIds.remove(it->key);
+                    m_writer->queue.erase(it);
+                }
+            }
+        }
+    }
+
+private:
+    const std::shared_ptr<ThemeImageCache::Writer> m_writer;
+};
+
+ThemeImageCache::ThemeImageCache()
+    : m_writer(std::make_shared<Writer>())
+{
+}
+
+ThemeImageCache::~ThemeImageCache()
+{
+    // a running writer finishes its batch and stops
+    clearQueue();
+    setSharedCache(nullptr);
+}
+
+void ThemeImageCache::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = qMax<qint64>(0, bytes);
+    shrink(m_memoryBudget);
+}
+
+qint64 ThemeImageCache::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void ThemeImageCache::setSharedCache(KImageCache *cache)
+{
+    QMutexLocker locker(&m_writer->sharedMutex);
+    m_writer->sharedCache = cache;
+}
+
+QDateTime ThemeImageCache::sharedLastModified() const
+{
+    QMutexLocker locker(&m_writer->sharedMutex);
+    return m_writer->sharedCache ? m_writer->sharedCache->lastModifiedTime() : QDateTime();
+}
+
+bool ThemeImageCache::find(const QString &key, const QString &path, const QString &element, QImage *image, bool shared, qreal devicePixelRatio,
+                           bool dependsOnColors)
+{
+    ConsumerStatistics &consumer = m_consumers[path];
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_uses.splice(m_uses.begin(), m_uses, it->use);
+        *image = it->image;
+        ++m_statistics[MemoryTier].hits;
+        ++consumer.hits;
+        return true;
+    }
+    ++m_statistics[MemoryTier].misses;
+
+    if (!shared) {
+        ++consumer.misses;
+        return false;
+    }
+
+    // renderings not written yet are as good as the ones in the shared tier
+    bool queued = false;
+    {
+        QMutexLocker locker(&m_writer->mutex);
+        const auto queuedIt = m_writer->queue.constFind(m_writer->queuedIds.value(key));
+        if (queuedIt != m_writer->queue.constEnd() && queuedIt->key == key) {
+            *image = queuedIt->image;
+            queued = true;
+        }
+    }
+    if (queued) {
+        ++consumer.hits;
+        insert(key, *image, path, element, dependsOnColors);
+        return true;
+    }
+
+    bool found = false;
+    {
+        QMutexLocker locker(&m_writer->sharedMutex);
+        found = m_writer->sharedCache && m_writer->sharedCache->findImage(key, image);
+    }
+    if (found && !image->isNull()) {
+        ++m_statistics[SharedTier].hits;
+        ++consumer.hits;
+        image->setDevicePixelRatio(devicePixelRatio);
+        insert(key, *image, path, element, dependsOnColors);
+        return true;
+    }
+
+    ++m_statistics[SharedTier].misses;
+    ++consumer.misses;
+    return false;
+}
+
+bool ThemeImageCache::findPixmap(const QString &key, const QString &path, const QString &element, QPixmap *pixmap, bool shared,
+                                 qreal devicePixelRatio, bool dependsOnColors)
+{
+    QImage image;
+    if (!find(key, path, element, &image, shared, devicePixelRatio, dependsOnColors)) {
+        return false;
+    }
+
+    // too big for the memory tier
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        *pixmap = QPixmap::fromImage(image);
+        return !pixmap->isNull();
+    }
+
+    if (it->pixmap.isNull()) {
+        addPixmap(*it, QPixmap::fromImage(image));
+        *pixmap = it->pixmap;
+        shrink(m_memoryBudget);
+    } else {
+        *pixmap = it->pixmap;
+    }
+    return !pixmap->isNull();
+}
+
+void ThemeImageCache::insert(const QString &key, const QImage &image, const QString &path, const QString &element, bool dependsOnColors,
+                             const QPixmap &pixmap)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        remove(it);
+    }
+
+    const qint64 bytes = image.sizeInBytes();
+    if (image.isNull() || bytes > m_memoryBudget) {
+        return;
+    }
+
+    shrink(m_memoryBudget - bytes);
+
+    m_uses.push_front(key);
+    Entry &entry = m_entries[key];
+    entry.image = image;
+    entry.path = path;
+    entry.element = element;
+    entry.bytes = bytes;
+    entry.dependsOnColors = dependsOnColors;
+    entry.use = m_uses.begin();
+
+    m_memoryUsed += bytes;
+    ++m_statistics[MemoryTier].insertions;
+
+    ConsumerStatistics &consumer = m_consumers[path];
+    consumer.bytes += bytes;
+    ++consumer.images;
+
+    if (!pixmap.isNull()) {
+        addPixmap(entry, pixmap);
+        shrink(m_memoryBudget);
+    }
+}
+
+void ThemeImageCache::addPixmap(Entry &entry, const QPixmap &pixmap)
+{
+    // accounted as what a raster pixmap takes
+    const qint64 bytes = qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    entry.pixmap = pixmap;
+    entry.bytes += bytes;
+    m_memoryUsed += bytes;
+    m_consumers[entry.path].bytes += bytes;
+}
+
+void ThemeImageCache::discard(const QString &key)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        remove(it);
+    }
+
+    QMutexLocker locker(&m_writer->mutex);
+    const auto idIt = m_writer->queuedIds.find(key);
+    if (idIt == m_writer->queuedIds.end()) {
+        return;
+    }
+    const auto queuedIt = m_writer->queue.find(*idIt);
+    if (queuedIt != m_writer->queue.end() && queuedIt->key == key) {
+        m_writer->queue.erase(queuedIt);
+    }
+    m_writer->queuedIds.erase(idIt);
+}
+
+void ThemeImageCache::enqueue(const QString &id, const QString &key, const QImage &image)
+{
+    QMutexLocker locker(&m_writer->mutex);
+    QueuedImage &queued = m_writer->queue[id];
+    if (!queued.key.isEmpty()) {
+        m_writer->queuedIds.remove(queued.key);
+    }
+    queued.key = key;
+    queued.image = image;
+    m_writer->queuedIds.insert(key, id);
+}
+
+bool ThemeImageCache::hasQueuedImages() const
+{
+    QMutexLocker locker(&m_writer->mutex);
+    return !m_writer->queue.isEmpty();
+}
+
+void ThemeImageCache::flushQueue()
+{
+    QMutexLocker locker(&m_writer->mutex);
+    if (m_writer->running || m_writer->queue.isEmpty()) {
+        return;
+    }
+
+    m_writer->running = true;
+    QThreadPool::globalInstance()->start(new ThemeImageWriter(m_writer));
+}
+
+int ThemeImageCache::flushBatchSize()
+{
+    return s_flushBatchSize;
+}
+
+void ThemeImageCache::clearMemory()
+{
+    m_entries.clear();
+    m_uses.clear();
+    m_memoryUsed = 0;
+
+    for (ConsumerStatistics &consumer : m_consumers) {
+        consumer.bytes = 0;
+        consumer.images = 0;
+    }
+}
+
+void ThemeImageCache::clearColorDependent()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->dependsOnColors) {
+            it = remove(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ThemeImageCache::clearQueue()
+{
+    QMutexLocker locker(&m_writer->mutex);
+    m_writer->queue.clear();
+    m_writer->queuedIds.clear();
+}
+
+void ThemeImageCache::clearShared()
+{
+    QMutexLocker locker(&m_writer->sharedMutex);
+    if (m_writer->sharedCache) {
+        m_writer->sharedCache->clear();
+    }
+}
+
+ThemeImageCache::TierStatistics ThemeImageCache::statistics(Tier tier) const
+{
+    TierStatistics statistics = m_statistics[tier];
+
+    if (tier == MemoryTier) {
+        statistics.budget = m_memoryBudget;
+        statistics.used = m_memoryUsed;
+        statistics.images = m_entries.count();
+    } else {
+        {
+            QMutexLocker locker(&m_writer->mutex);
+            statistics.insertions = m_writer->insertions;
+            statistics.queued = m_writer->queue.count();
+            statistics.flushes = m_writer->flushes;
+            statistics.lastFlushTime = m_writer->lastFlushTime;
+        }
+
+        QMutexLocker locker(&m_writer->sharedMutex);
+        if (m_writer->sharedCache) {
+            statistics.budget = m_writer->sharedCache->totalSize();
+            statistics.used = m_writer->sharedCache->totalSize() - m_writer->sharedCache->freeSize();
+        }
+    }
+
+    return statistics;
+}
+
+const QHash<QString, ThemeImageCache::ConsumerStatistics> &ThemeImageCache::consumers() const
+{
+    return m_consumers;
+}
+
+QHash<QString, qint64> ThemeImageCache::elementBytes(const QString &path) const
+{
+    QHash<QString, qint64> bytes;
+    for (const Entry &entry : m_entries) {
+        if (entry.path == path) {
+            bytes[entry.element] += entry.bytes;
+        }
+    }
+    return bytes;
+}
+
+QHash<QString, ThemeImageCache::Entry>::iterator ThemeImageCache::remove(QHash<QString, Entry>::iterator it)
+{
+    auto consumerIt = m_consumers.find(it->path);
+    if (consumerIt != m_consumers.end()) {
+        consumerIt->bytes -= it->bytes;
+        --consumerIt->images;
+    }
+
+    m_memoryUsed -= it->bytes;
+    m_uses.erase(it->use);
+    return m_entries.erase(it);
+}
+
+void ThemeImageCache::shrink(qint64 budget)
+{
+    while (m_memoryUsed > budget && !m_uses.empty()) {
+        remove(m_entries.find(m_uses.back()));
+        ++m_statistics[MemoryTier].evictions;
+    }
+}
+
+}
@@ -0,0 +1,151 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef PLASMA_THEMEIMAGECACHE_P_H
+#define PLASMA_THEMEIMAGECACHE_P_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QString>
+
+#include <list>
+#include <memory>
+
+class KImageCache;
+
+namespace Plasma
+{
+
+// The images rendered with a theme, in two tiers:
+// - the memory tier keeps the most recently used images of this process,
+//   within a byte budget, and hands out the very same QImage on every hit,
+//   or the very same QPixmap, converted once, to the users of pixmaps;
+// - the shared tier is the KImageCache of the theme, shared between all the
+//   processes using it and backed by a file, so it survives restarts too.
+// New images wait in a queue before being written to the shared tier, where
+// only the last one rendered for each id (a Svg or FrameSvg element) ends up.
+// The queue is written by a worker thread, in batches; every access to the
+// KImageCache goes through a lock, held by the worker for one batch at most.
+class ThemeImageCache
+{
+public:
+    enum Tier {
+        MemoryTier = 0,
+        SharedTier,
+    };
+
+    struct TierStatistics {
+        qint64 budget = 0;
+        qint64 used = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 insertions = 0;
+        // the images and evictions of the shared tier aren't known, KImageCache evicts silently
+        int images = 0;
+        quint64 evictions = 0;
+        // shared tier only: the images waiting to be written, the runs of the
+        // writer and how long the last one took to empty the queue, in milliseconds
+        int queued = 0;
+        quint64 flushes = 0;
+        qint64 lastFlushTime = 0;
+    };
+
+    // what the renderings of an image path take in the memory tier,
+    // and how often they were looked up in any tier
+    struct ConsumerStatistics {
+        qint64 bytes = 0;
+        int images = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+    };
+
+    ThemeImageCache();
+    ~ThemeImageCache();
+
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+
+    // not owned, null while the theme isn't cached on disk; once this returns
+    // the writer doesn't use the previous cache anymore, so it can be deleted
+    void setSharedCache(KImageCache *cache);
+    QDateTime sharedLastModified() const;
+
+    /**
+     * Looks in the memory tier, then if shared is true in the queue and in the
+     * shared tier. Images found outside of memory are kept in memory from then on,
+     * the ones from the shared tier with the given device pixel ratio.
+     */
+    bool find(const QString &key, const QString &path, const QString &element, QImage *image, bool shared, qreal devicePixelRatio = 1,
+              bool dependsOnColors = true);
+    // same as find(), the pixmap is kept along the image in the memory tier
+    bool findPixmap(const QString &key, const QString &path, const QString &element, QPixmap *pixmap, bool shared, qreal devicePixelRatio = 1,
+                    bool dependsOnColors = true);
+    // images depending on the colors are dropped from memory by clearColorDependent();
+    // pixmap, if any, is the same rendering as image, handed out by findPixmap()
+    void insert(const QString &key, const QImage &image, const QString &path, const QString &element, bool dependsOnColors = true,
+                const QPixmap &pixmap = QPixmap());
+    // drops key from memory and from the queue, what the shared tier has of it stays
+    void discard(const QString &key);
+    // queues image to be written to the shared tier, replacing what id had queued
+    void enqueue(const QString &id, const QString &key, const QImage &image);
+
+    bool hasQueuedImages() const;
+    // starts writing the queue in the background, if not being written already
+    void flushQueue();
+    // number of images written to the shared tier in one go
+    static int flushBatchSize();
+
+    void clearMemory();
+    // the queue is written all the same, the keys of these images have the colors they use
+    void clearColorDependent();
+    void clearQueue();
+    void clearShared();
+
+    TierStatistics statistics(Tier tier) const;
+    const QHash<QString, ConsumerStatistics> &consumers() const;
+    // what each element of path takes in the memory tier
+    QHash<QString, qint64> elementBytes(const QString &path) const;
+
+private:
+    struct Entry {
+        QImage image;
+        QPixmap pixmap;
+        QString path;
+        QString element;
+        qint64 bytes = 0;
+        bool dependsOnColors = true;
+        std::list<QString>::iterator use;
+    };
+
+    struct QueuedImage {
+        QString key;
+        QImage image;
+    };
+    // the queue and the shared cache, shared with the writer
+    struct Writer;
+    friend class ThemeImageWriter;
+
+    QHash<QString, Entry>::iterator remove(QHash<QString, Entry>::iterator it);
+    void addPixmap(Entry &entry, const QPixmap &pixmap);
+    void shrink(qint64 budget);
+
+    QHash<QString, Entry> m_entries;
+    // the keys in the memory tier, the most recently used first
+    std::list<QString> m_uses;
+    qint64 m_memoryBudget = 0;
+    qint64 m_memoryUsed = 0;
+
+    std::shared_ptr<Writer> m_writer;
+
+    QHash<QString, ConsumerStatistics> m_consumers;
+    TierStatistics m_statistics[SharedTier + 1];
+};
+
+}
+
+#endif
@@ -16,6 +16,7 @@
 #include <QDir>
 #include <QMatrix>
 #include <QPainter>
+#include <QReadWriteLock>
 #include <QStringBuilder>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
@@ -40,8 +41,8 @@ uint qHash(const Plasma::SvgPrivate::CacheId &id, uint seed)
     std::array<uint, 10> parts = {
         ::qHash(id.width),
         ::qHash(id.height),
-        ::qHash(id.elementName),
-        ::qHash(id.filePath),
+        id.elementName,
+        Plasma::SvgStringTable::hash(id.filePath),
         ::qHash(id.status),
         ::qHash(id.devicePixelRatio),
         ::qHash(id.scaleFactor),
@@ -64,74 +65,171 @@ public:
 
 Q_GLOBAL_STATIC(SvgRectsCacheSingleton, privateSvgRectsCacheSelf)
 
+struct SvgStringTableData
+{
+    SvgStringTableData()
+    {
+        // id 0 is always the empty string
+        ids.insert(QString(), 0);
+        strings.append(QString());
+        hashes.append(::qHash(QString()));
+    }
+
+    QReadWriteLock lock;
+    QHash<QString, uint> ids;
+    QVector<QString> strings;
+    QVector<uint> hashes;
+};
+
+Q_GLOBAL_STATIC(SvgStringTableData, s_stringTable)
+
+uint SvgStringTable::intern(const QString &string)
+{
+    SvgStringTableData *table = s_stringTable();
+    {
+        QReadLocker locker(&table->lock);
+        auto it = table->ids.constFind(string);
+        if (it != table->ids.constEnd()) {
+            return *it;
+        }
+    }
+
+    QWriteLocker locker(&table->lock);
+    // another thread may have added it meanwhile
+    auto it = table->ids.constFind(string);
+    if (it != table->ids.constEnd()) {
+        return *it;
+    }
+
+    const uint id = table->strings.size();
+    table->ids.insert(string, id);
+    table->strings.append(string);
+    table->hashes.append(::qHash(string));
+    return id;
+}
+
+QString SvgStringTable::string(uint id)
+{
+    SvgStringTableData *table = s_stringTable();
+    QReadLocker locker(&table->lock);
+    return table->strings.value(id);
+}
+
+uint SvgStringTable::hash(uint id)
+{
+    SvgStringTableData *table = s_stringTable();
+    QReadLocker locker(&table->lock);
+    return table->hashes.value(id);
+}
+
 const uint SvgRectsCache::s_seed = 0x9e3779b9;
 
-SharedSvgRenderer::SharedSvgRenderer(QObject *parent)
-    : QSvgRenderer(parent)
+// Placeholder for the color scheme stylesheet in the preprocessed svg sources
+static const QByteArray s_styleSheetMarker = QByteArrayLiteral("%plasma-current-color-scheme%");
+
+SvgSource::SvgSource(const QByteArray &contents)
 {
+    if (!contents.contains("current-color-scheme")) {
+        m_parts << contents;
+        return;
+    }
+
+    // Replace the contents of the current-color-scheme style with a placeholder,
+    // so that a stylesheet can then be applied without parsing the xml again
+    QByteArray processedContents;
+    processedContents.reserve(contents.size());
+    QXmlStreamReader reader(contents);
+
+    QBuffer buffer(&processedContents);
+    buffer.open(QIODevice::WriteOnly);
+    QXmlStreamWriter writer(&buffer);
+    while (!reader.atEnd()) {
+        if (reader.readNext() == QXmlStreamReader::StartElement &&
+            reader.qualifiedName() == QLatin1String("style") &&
+            reader.attributes().value(QLatin1String("id")) == QLatin1String("current-color-scheme")) {
+            writer.writeStartElement(QLatin1String("style"));
+            writer.writeAttributes(reader.attributes());
+            writer.writeCharacters(QString::fromLatin1(s_styleSheetMarker));
+            writer.writeEndElement();
+            while (reader.tokenType() != QXmlStreamReader::EndElement) {
+                reader.readNext();
+            }
+        } else if (reader.tokenType() != QXmlStreamReader::Invalid) {
+            writer.writeCurrentToken(reader);
+        }
+    }
+    buffer.close();
+
+    int from = 0;
+    int index;
+    while ((index = processedContents.indexOf(s_styleSheetMarker, from)) != -1) {
+        m_parts << processedContents.mid(from, index - from);
+        from = index + s_styleSheetMarker.size();
+    }
+    m_parts << processedContents.mid(from);
 }
 
-SharedSvgRenderer::SharedSvgRenderer(
-    const QString &filename,
-    const QString &styleSheet,
-    QHash<QString, QRectF> &interestingElements,
-    QObject *parent)
-    : QSvgRenderer(parent)
+SvgSource::Ptr SvgSource::fromFile(const QString &filename)
 {
     KCompressionDevice file(filename, KCompressionDevice::GZip);
     if (!file.open(QIODevice::ReadOnly)) {
-        return;
+        return Ptr(new SvgSource(QByteArray()));
+    }
+    return Ptr(new SvgSource(file.readAll()));
+}
+
+bool SvgSource::usesColorScheme() const
+{
+    return m_parts.size() > 1;
+}
+
+QByteArray SvgSource::contents(const QString &styleSheet) const
+{
+    if (!usesColorScheme()) {
+        return m_parts.first();
     }
-    load(file.readAll(), styleSheet, interestingElements);
+
+    const QByteArray styleSheetData = styleSheet.toHtmlEscaped().toUtf8();
+    QByteArray contents;
+    contents.reserve(m_parts.first().size() * 2);
+    for (int i = 0; i < m_parts.size(); ++i) {
+        if (i > 0) {
+            contents += styleSheetData;
+        }
+        contents += m_parts.at(i);
+    }
+    return contents;
+}
+
+SharedSvgRenderer::SharedSvgRenderer(QObject *parent)
+    : QSvgRenderer(parent)
+{
 }
 
 SharedSvgRenderer::SharedSvgRenderer(
-    const QByteArray &contents,
+    const SvgSource::Ptr &source,
     const QString &styleSheet,
-    QHash<QString, QRectF> &interestingElements,
     QObject *parent)
-    : QSvgRenderer(parent)
+    : QSvgRenderer(parent),
+      m_source(source)
 {
-    load(contents, styleSheet, interestingElements);
+    load(source, styleSheet);
 }
 
 bool SharedSvgRenderer::load(
-    const QByteArray &contents,
-    const QString &styleSheet,
-    QHash<QString, QRectF> &interestingElements)
-{
-    // Apply the style sheet.
-    if (!styleSheet.isEmpty() && contents.contains("current-color-scheme")) {
-        QByteArray processedContents;
-        processedContents.reserve(contents.size());
-        QXmlStreamReader reader(contents);
-
-        QBuffer buffer(&processedContents);
-        buffer.open(QIODevice::WriteOnly);
-        QXmlStreamWriter writer(&buffer);
-        while (!reader.atEnd()) {
-            if (reader.readNext() == QXmlStreamReader::StartElement &&
-                reader.qualifiedName() == QLatin1String("style") &&
-                reader.attributes().value(QLatin1String("id")) == QLatin1String("current-color-scheme")) {
-                writer.writeStartElement(QLatin1String("style"));
-                writer.writeAttributes(reader.attributes());
-                writer.writeCharacters(styleSheet);
-                writer.writeEndElement();
-                while (reader.tokenType() != QXmlStreamReader::EndElement) {
-                    reader.readNext();
-                }
-            } else if (reader.tokenType() != QXmlStreamReader::Invalid) {
-                writer.writeCurrentToken(reader);
-            }
-        }
-        buffer.close();
-        if (!QSvgRenderer::load(processedContents)) {
-            return false;
-        }
-    } else if (!QSvgRenderer::load(contents)) {
+    const SvgSource::Ptr &source,
+    const QString &styleSheet)
+{
+    const QByteArray contents = source->contents(styleSheet);
+    if (!QSvgRenderer::load(contents)) {
         return false;
     }
 
+    if (source->interestingElementsScanned) {
+        return true;
+    }
+    source->interestingElementsScanned = true;
+
     // Search the SVG to find and store all ids that contain size hints.
     const QString contentsAsString(QString::fromLatin1(contents));
     static const QRegularExpression idExpr(QLatin1String("id\\s*?=\\s*?(['\"])(\\d+?-\\d+?-.*?)\\1"));
@@ -144,7 +242,7 @@ bool SharedSvgRenderer::load(
 
         QRectF elementRect = boundsOnElement(elementId);
         if (elementRect.isValid()) {
-            interestingElements.insert(elementId, elementRect);
+            source->interestingElements.insert(elementId, elementRect);
         }
     }
 
@@ -173,7 +271,7 @@ SvgRectsCache *SvgRectsCache::instance()
 
 void SvgRectsCache::insert(Plasma::SvgPrivate::CacheId cacheId, const QRectF &rect, unsigned int lastModified)
 {
-    insert(qHash(cacheId, SvgRectsCache::s_seed), cacheId.filePath, rect, lastModified);
+    insert(qHash(cacheId, SvgRectsCache::s_seed), SvgStringTable::string(cacheId.filePath), rect, lastModified);
 }
 
 void SvgRectsCache::insert(uint id, const QString &filePath, const QRectF &rect, unsigned int lastModified)
@@ -197,7 +295,16 @@ void SvgRectsCache::insert(uint id, const QString &filePath, const QRectF &rect,
 
 bool SvgRectsCache::findElementRect(Plasma::SvgPrivate::CacheId cacheId, QRectF &rect)
 {
-    return findElementRect(qHash(cacheId, SvgRectsCache::s_seed), cacheId.filePath, rect);
+    const uint id = qHash(cacheId, SvgRectsCache::s_seed);
+
+    // fast path, the path string is needed only for elements known as invalid
+    auto it = m_localRectCache.constFind(id);
+    if (it != m_localRectCache.constEnd()) {
+        rect = *it;
+        return true;
+    }
+
+    return findElementRect(id, SvgStringTable::string(cacheId.filePath), rect);
 }
 
 bool SvgRectsCache::findElementRect(uint id, const QString &filePath, QRectF &rect)
@@ -346,6 +453,19 @@ QSizeF SvgRectsCache::naturalSize(const QString &path, qreal scaleFactor)
     return imageGroup.readEntry(QStringLiteral("NaturalSize_") % QString::number(scaleFactor), QSizeF());
 }
 
+void SvgRectsCache::setUsesColorScheme(const QString &path, bool uses)
+{
+    KConfigGroup imageGroup(m_svgElementsCache, path);
+    imageGroup.writeEntry(QStringLiteral("UsesColorScheme"), uses);
+    QMetaObject::invokeMethod(m_configSyncTimer, QOverload<>::of(&QTimer::start));
+}
+
+bool SvgRectsCache::usesColorScheme(const QString &path, bool defaultValue)
+{
+    KConfigGroup imageGroup(m_svgElementsCache, path);
+    return imageGroup.readEntry(QStringLiteral("UsesColorScheme"), defaultValue);
+}
+
 QStringList SvgRectsCache::cachedKeysForPath(const QString &path) const
 {
     KConfigGroup imageGroup(m_svgElementsCache, path);
@@ -378,6 +498,7 @@ SvgPrivate::SvgPrivate(Svg *svg)
       fromCurrentTheme(false),
       applyColors(false),
       usesColors(false),
+      dependsOnColors(false),
       cacheRendering(true),
       themeFailed(false)
 {
@@ -390,16 +511,40 @@ SvgPrivate::~SvgPrivate()
 
 //This function is meant for the rects cache
 SvgPrivate::CacheId SvgPrivate::cacheId(const QString &elementId) const
+{
+    return cacheId(svgElementHash(elementId));
+}
+
+SvgPrivate::CacheId SvgPrivate::cacheId(uint elementHash) const
 {
     auto idSize = size.isValid() && size != naturalSize ? size : QSizeF{-1.0, -1.0};
-    return CacheId{idSize.width(), idSize.height(), path, elementId, status, devicePixelRatio, scaleFactor, -1, 0, lastModified};
+    return CacheId{idSize.width(), idSize.height(), pathId(), elementHash, status, devicePixelRatio, scaleFactor, -1, 0, lastModified};
+}
+
+uint SvgPrivate::pathId() const
+{
+    return internedPath.value(path);
 }
 
 //This function is meant for the pixmap cache
-QString SvgPrivate::cachePath(const QString &id, const QSize &size) const
+QString SvgPrivate::cachePath(uint elementHash, const QSize &size)
+{
+    auto cacheId = CacheId{double(size.width()), double(size.height()), pathId(), elementHash, status, devicePixelRatio, scaleFactor, colorGroup, 0, lastModified};
+    uint hash = qHash(cacheId, SvgRectsCache::s_seed);
+    // renderings using the colors are kept apart for every color scheme, so
+    // changing colors doesn't need to drop the ones which don't use them
+    if (const uint colors = colorsHash()) {
+        hash = qHash(qMakePair(hash, colors), SvgRectsCache::s_seed);
+    }
+    return QString::number(hash);
+}
+
+uint SvgPrivate::colorsHash()
 {
-    auto cacheId = CacheId{double(size.width()), double(size.height()), path, id, status, devicePixelRatio, scaleFactor, colorGroup, 0, lastModified};
-    return QString::number(qHash(cacheId, SvgRectsCache::s_seed));
+    if (!dependsOnColors) {
+        return 0;
+    }
+    return cacheAndColorsTheme()->d->colorTable()->hash;
 }
 
 bool SvgPrivate::setImagePath(const QString &imagePath)
@@ -475,6 +620,7 @@ bool SvgPrivate::setImagePath(const QString &imagePath)
 
     // check if svg wants colorscheme applied
     checkColorHints();
+    checkColorDependency(s_sources.value(path));
 
     // also images with absolute path needs to have a natural size initialized,
     // even if looks a bit weird using Theme to store non-themed stuff
@@ -519,11 +665,8 @@ Theme *SvgPrivate::cacheAndColorsTheme()
     }
 }
 
-QPixmap SvgPrivate::findInCache(const QString &elementId, qreal ratio, const QSizeF &s)
+QSize SvgPrivate::renderSize(const QString &elementId, qreal ratio, const QSizeF &s, QString &actualElementId)
 {
-    QSize size;
-    QString actualElementId;
-
     // Look at the size hinted elements and try to find the smallest one with an
     // identical aspect ratio.
     if (s.isValid() && !elementId.isEmpty()) {
@@ -553,58 +696,116 @@ QPixmap SvgPrivate::findInCache(const QString &elementId, qreal ratio, const QSi
     }
 
     if (elementId.isEmpty() || (multipleImages && s.isValid())) {
-        size = s.toSize() * ratio;
+        return s.toSize() * ratio;
+    } else {
+        return elementRect(actualElementId).size().toSize() * ratio;
+    }
+}
+
+void SvgPrivate::render(QPaintDevice *device, const QString &actualElementId, const QSize &size)
+{
+    createRenderer();
+
+    QRectF finalRect = makeUniform(renderer->boundsOnElement(actualElementId), QRect(QPoint(0, 0), size));
+
+    QPainter renderPainter(device);
+
+    if (actualElementId.isEmpty()) {
+        renderer->render(&renderPainter, finalRect);
     } else {
-        size = elementRect(actualElementId).size().toSize() * ratio;
+        renderer->render(&renderPainter, actualElementId, finalRect);
     }
+}
+
+QImage SvgPrivate::renderImage(const QString &actualElementId, const QSize &size, qreal ratio)
+{
+    //don't alter the image size or it won't match up properly to, e.g., FrameSvg elements
+    //makeUniform should never change the size so much that it gains or loses a whole pixel
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    render(&image, actualElementId, size);
+
+    // Apply current color scheme if the svg asks for it
+    if (applyColors) {
+        KIconEffect::colorize(image, cacheAndColorsTheme()->color(Theme::BackgroundColor), 1.0);
+    }
+
+    image.setDevicePixelRatio(ratio);
+    return image;
+}
+
+QPixmap SvgPrivate::findInCache(const QString &elementId, qreal ratio, const QSizeF &s)
+{
+    QString actualElementId;
+    const QSize size = renderSize(elementId, ratio, s, actualElementId);
 
     if (size.isEmpty()) {
         return QPixmap();
     }
 
-    const QString id = cachePath(actualElementId, size);
+    const uint elementHash = svgElementHash(actualElementId);
+    QString id = cachePath(elementHash, size);
+    const bool dependedOnColors = dependsOnColors;
+    ThemePrivate *themeD = cacheAndColorsTheme()->d;
 
+    // the memory tier keeps the pixmap, converted from the image only once
     QPixmap p;
-    if (cacheRendering && cacheAndColorsTheme()->findInCache(id, p, lastModified)) {
-        p.setDevicePixelRatio(ratio);
+    if (cacheRendering && themeD->findInCache(id, p, lastModified, path, actualElementId, ratio, dependsOnColors)) {
         //qCDebug(LOG_PLASMA) << "found cached version of " << id << p.size();
         return p;
     }
 
-    createRenderer();
+    // rendered as an image, which is what the cache keeps and writes to disk
+    const QImage image = renderImage(actualElementId, size, ratio);
+    p = QPixmap::fromImage(image);
 
-    QRectF finalRect = makeUniform(renderer->boundsOnElement(actualElementId), QRect(QPoint(0, 0), size));
+    if (cacheRendering) {
+        // rendering may have read the source for the first time, telling whether the colors matter after all
+        if (dependsOnColors != dependedOnColors) {
+            id = cachePath(elementHash, size);
+        }
+        themeD->insertIntoCache(id, image, QString::number((qint64)q, 16) % QLatin1Char('_') % actualElementId, path, actualElementId, dependsOnColors, p);
+    }
 
-    //don't alter the pixmap size or it won't match up properly to, e.g., FrameSvg elements
-    //makeUniform should never change the size so much that it gains or loses a whole pixel
-    p = QPixmap(size);
+    SvgRectsCache::instance()->updateLastModified(path, lastModified);
 
-    p.fill(Qt::transparent);
-    QPainter renderPainter(&p);
+    return p;
+}
 
-    if (actualElementId.isEmpty()) {
-        renderer->render(&renderPainter, finalRect);
-    } else {
-        renderer->render(&renderPainter, actualElementId, finalRect);
+QImage SvgPrivate::findImageInCache(const QString &elementId, qreal ratio, const QSizeF &s)
+{
+    QString actualElementId;
+    const QSize size = renderSize(elementId, ratio, s, actualElementId);
+
+    if (size.isEmpty()) {
+        return QImage();
     }
 
-    renderPainter.end();
-    p.setDevicePixelRatio(ratio);
+    const uint elementHash = svgElementHash(actualElementId);
+    QString id = cachePath(elementHash, size);
+    const bool dependedOnColors = dependsOnColors;
+    ThemePrivate *themeD = cacheAndColorsTheme()->d;
 
-    // Apply current color scheme if the svg asks for it
-    if (applyColors) {
-        QImage itmp = p.toImage();
-        KIconEffect::colorize(itmp, cacheAndColorsTheme()->color(Theme::BackgroundColor), 1.0);
-        p = p.fromImage(itmp);
+    // handing out the very same image lets users share whatever they derive from it,
+    // like the scene graph textures of SvgItem, which are keyed on QImage::cacheKey()
+    QImage image;
+    if (cacheRendering && themeD->findInCache(id, image, lastModified, path, actualElementId, ratio, dependsOnColors)) {
+        return image;
     }
 
+    image = renderImage(actualElementId, size, ratio);
+
     if (cacheRendering) {
-        cacheAndColorsTheme()->insertIntoCache(id, p, QString::number((qint64)q, 16) % QLatin1Char('_') % actualElementId);
+        // rendering may have read the source for the first time, telling whether the colors matter after all
+        if (dependsOnColors != dependedOnColors) {
+            id = cachePath(elementHash, size);
+        }
+        themeD->insertIntoCache(id, image, QString::number((qint64)q, 16) % QLatin1Char('_') % actualElementId, path, actualElementId, dependsOnColors);
     }
 
     SvgRectsCache::instance()->updateLastModified(path, lastModified);
 
-    return p;
+    return image;
 }
 
 void SvgPrivate::createRenderer()
@@ -636,8 +837,31 @@ void SvgPrivate::createRenderer()
         }
     }
 
-    QString styleSheet = cacheAndColorsTheme()->d->svgStyleSheet(colorGroup, status);
-    styleCrc = qChecksum(styleSheet.toUtf8().constData(), styleSheet.size());
+    SvgSource::Ptr source;
+    if (!path.isEmpty()) {
+        auto sourceIt = s_sources.constFind(path);
+        if (sourceIt != s_sources.constEnd()) {
+            source = sourceIt.value();
+        } else {
+            source = SvgSource::fromFile(path);
+            s_sources.insert(path, source);
+            SvgRectsCache::instance()->setUsesColorScheme(path, source->usesColorScheme());
+        }
+        checkColorDependency(source);
+    }
+
+    // Svgs that don't use the color scheme render the same for every color
+    // group and status, so they can share a single renderer. The others need
+    // a renderer per distinct stylesheet: QSvgRenderer resolves the css while
+    // parsing and has no way to share a document, so each of those renderers
+    // parses the file again, only the reading and preprocessing are shared
+    QString styleSheet;
+    if (source && source->usesColorScheme()) {
+        styleSheet = cacheAndColorsTheme()->d->svgStyleSheet(colorGroup, status);
+        styleCrc = qChecksum(styleSheet.toUtf8().constData(), styleSheet.size());
+    } else {
+        styleCrc = 0;
+    }
 
     QHash<QString, SharedSvgRenderer::Ptr>::const_iterator it = s_renderers.constFind(styleCrc + path);
 
@@ -647,24 +871,26 @@ void SvgPrivate::createRenderer()
         if (path.isEmpty()) {
             renderer = new SharedSvgRenderer();
         } else {
-            QHash<QString, QRectF> interestingElements;
-            renderer = new SharedSvgRenderer(path, styleSheet, interestingElements);
+            const bool firstLoad = !source->interestingElementsScanned;
+            renderer = new SharedSvgRenderer(source, styleSheet);
 
             // Add interesting elements to the theme's rect cache.
-            QHashIterator<QString, QRectF> i(interestingElements);
+            QHashIterator<QString, QRectF> i(source->interestingElements);
 
             QRegularExpression sizeHintedKeyExpr(QStringLiteral("^(\\d+)-(\\d+)-(.+)$"));
 
             while (i.hasNext()) {
                 i.next();
                 const QString &elementId = i.key();
-                QString originalId = i.key();
                 const QRectF &elementRect = i.value();
 
-                originalId.replace(sizeHintedKeyExpr, QStringLiteral("\\3"));
-                SvgRectsCache::instance()->insertSizeHintForId(path, originalId, elementRect.size().toSize());
+                if (firstLoad) {
+                    QString originalId = i.key();
+                    originalId.replace(sizeHintedKeyExpr, QStringLiteral("\\3"));
+                    SvgRectsCache::instance()->insertSizeHintForId(path, originalId, elementRect.size().toSize());
+                }
 
-                const CacheId cacheId({-1.0, -1.0, path, elementId, status, devicePixelRatio, scaleFactor, -1, 0, lastModified});
+                const CacheId cacheId({-1.0, -1.0, pathId(), svgElementHash(elementId), status, devicePixelRatio, scaleFactor, -1, 0, lastModified});
                 SvgRectsCache::instance()->insert(cacheId, elementRect, lastModified);
             }
         }
@@ -687,6 +913,12 @@ void SvgPrivate::eraseRenderer()
 
     renderer = nullptr;
     styleCrc = 0;
+
+    // drop the source as well once no renderer for the file is left
+    auto sourceIt = s_sources.find(path);
+    if (sourceIt != s_sources.end() && sourceIt.value()->ref.loadRelaxed() == 1) {
+        s_sources.erase(sourceIt);
+    }
 }
 
 QRectF SvgPrivate::elementRect(const QString &elementId)
@@ -713,16 +945,15 @@ QRectF SvgPrivate::elementRect(const QString &elementId)
     bool found = SvgRectsCache::instance()->findElementRect(cacheId, rect);
     //This is a corner case where we are *sure* the element is not valid
     if (!found) {
-        rect = findAndCacheElementRect(elementId);
+        rect = findAndCacheElementRect(elementId, cacheId);
     }
 
     return rect;
 }
 
-QRectF SvgPrivate::findAndCacheElementRect(const QString &elementId)
+QRectF SvgPrivate::findAndCacheElementRect(const QString &elementId, const CacheId &cacheId)
 {
-    //we need to check the id before createRenderer(), otherwise it may generate a different id compared to the previous cacheId)( call
-    const CacheId cacheId = SvgPrivate::cacheId(elementId);
+    //cacheId has to be computed before createRenderer(), otherwise it may generate a different id compared to the lookup
 
     createRenderer();
 
@@ -770,6 +1001,18 @@ void SvgPrivate::checkColorHints()
     }
 }
 
+void SvgPrivate::checkColorDependency(const SvgSource::Ptr &source)
+{
+    if (usesColors) {
+        dependsOnColors = true;
+    } else if (source) {
+        dependsOnColors = source->usesColorScheme();
+    } else {
+        // don't read the file just for this, at startup most of them are rendered from the cache
+        dependsOnColors = !path.isEmpty() && SvgRectsCache::instance()->usesColorScheme(path, true);
+    }
+}
+
 bool Svg::eventFilter(QObject *watched, QEvent *event)
 {
     return QObject::eventFilter(watched, event);
@@ -858,6 +1101,7 @@ void SvgPrivate::colorsChanged()
 }
 
 QHash<QString, SharedSvgRenderer::Ptr> SvgPrivate::s_renderers;
+QHash<QString, SvgSource::Ptr> SvgPrivate::s_sources;
 QPointer<Theme> SvgPrivate::s_systemColorsCache;
 qreal SvgPrivate::s_lastScaleFactor = 1.0;
 
@@ -955,8 +1199,7 @@ QPixmap Svg::pixmap(const QString &elementID)
 
 QImage Svg::image(const QSize &size, const QString &elementID)
 {
-    QPixmap pix(d->findInCache(elementID, d->devicePixelRatio, size));
-    return pix.toImage();
+    return d->findImageInCache(elementID, d->devicePixelRatio, size);
 }
 
 void Svg::paint(QPainter *painter, const QPointF &point, const QString &elementID)
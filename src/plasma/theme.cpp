@@ -128,46 +128,13 @@ QString Theme::themeName() const
 
 QString Theme::imagePath(const QString &name) const
 {
-    // look for a compressed svg file in the theme
     if (name.contains(QLatin1String("../")) || name.isEmpty()) {
         // we don't support relative paths
         //qCDebug(LOG_PLASMA) << "Theme says: bad image path " << name;
         return QString();
     }
 
-    const QString svgzName = name % QLatin1String(".svgz");
-    QString path = d->findInTheme(svgzName, d->themeName);
-
-    if (path.isEmpty()) {
-        // try for an uncompressed svg file
-        const QString svgName = name % QLatin1String(".svg");
-        path = d->findInTheme(svgName, d->themeName);
-
-        // search in fallback themes if necessary
-        for (int i = 0; path.isEmpty() && i < d->fallbackThemes.count(); ++i) {
-            if (d->themeName == d->fallbackThemes[i]) {
-                continue;
-            }
-
-            // try a compressed svg file in the fallback theme
-            path = d->findInTheme(svgzName, d->fallbackThemes[i]);
-
-            if (path.isEmpty()) {
-                // try an uncompressed svg file in the fallback theme
-                path = d->findInTheme(svgName, d->fallbackThemes[i]);
-            }
-        }
-    }
-
-    /*
-    if (path.isEmpty()) {
-    #ifndef NDEBUG
-        // qCDebug(LOG_PLASMA) << "Theme says: bad image path " << name;
-    #endif
-    }
-    */
-
-    return path;
+    return d->findImage(name);
 }
 
 QString Theme::backgroundPath(const QString& image) const
@@ -188,52 +155,7 @@ QPalette Theme::palette() const
 
 QString Theme::wallpaperPath(const QSize &size) const
 {
-    QString fullPath;
-    QString image = d->defaultWallpaperTheme + QStringLiteral("/contents/images/%1x%2") + d->defaultWallpaperSuffix;
-    QString defaultImage = image.arg(d->defaultWallpaperWidth).arg(d->defaultWallpaperHeight);
-
-    if (size.isValid()) {
-        // try to customize the paper to the size requested
-        //TODO: this should do better than just fallback to the default size.
-        //      a "best fit" matching would be far better, so we don't end
-        //      up returning a 1920x1200 wallpaper for a 640x480 request ;)
-        image = image.arg(size.width()).arg(size.height());
-    } else {
-        image = defaultImage;
-    }
-
-    //TODO: the theme's wallpaper overrides regularly installed wallpapers.
-    //      should it be possible for user installed (e.g. locateLocal) wallpapers
-    //      to override the theme?
-    if (d->hasWallpapers) {
-        // check in the theme first
-        fullPath = d->findInTheme(QLatin1String("wallpapers/") % image, d->themeName);
-
-        if (fullPath.isEmpty()) {
-            fullPath = d->findInTheme(QLatin1String("wallpapers/") % defaultImage, d->themeName);
-        }
-    }
-
-    if (fullPath.isEmpty()) {
-        // we failed to find it in the theme, so look in the standard directories
-        //qCDebug(LOG_PLASMA) << "looking for" << image;
-        fullPath = QStandardPaths::locate(QStandardPaths::GenericDataLocation, QLatin1String("wallpapers/") + image);
-    }
-
-    if (fullPath.isEmpty()) {
-        // we still failed to find it in the theme, so look for the default in
-        // the standard directories
-        //qCDebug(LOG_PLASMA) << "looking for" << defaultImage;
-        fullPath = QStandardPaths::locate(QStandardPaths::GenericDataLocation, QLatin1String("wallpapers/") + defaultImage);
-
-        if (fullPath.isEmpty()) {
-#ifndef NDEBUG
-            // qCDebug(LOG_PLASMA) << "exhausted every effort to find a wallpaper.";
-#endif
-        }
-    }
-
-    return fullPath;
+    return d->findWallpaper(size);
 }
 
 QString Theme::wallpaperPathForSize(int width, int height) const
@@ -248,8 +170,8 @@ bool Theme::currentThemeHasImage(const QString &name) const
         return false;
     }
 
-    return !(d->findInTheme(name % QLatin1String(".svgz"), d->themeName, false).isEmpty()) ||
-           !(d->findInTheme(name % QLatin1String(".svg"), d->themeName, false).isEmpty());
+    return !(d->findInTheme(name % QLatin1String(".svgz"), d->themeName).isEmpty()) ||
+           !(d->findInTheme(name % QLatin1String(".svg"), d->themeName).isEmpty());
 }
 
 KSharedConfigPtr Theme::colorScheme() const
@@ -287,47 +209,19 @@ bool Theme::findInCache(const QString &key, QPixmap &pix, unsigned int lastModif
         return false;
     }
 
-    if (!d->useCache()) {
-        return false;
-    }
-
-    if (lastModified > uint(d->pixmapCache->lastModifiedTime().toSecsSinceEpoch())) {
-        return false;
-    }
-
-    const QString id = d->keysToCache.value(key);
-    const auto it = d->pixmapsToCache.constFind(id);
-    if (it != d->pixmapsToCache.constEnd()) {
-        pix = *it;
-        return !pix.isNull();
-    }
-
-    QPixmap temp;
-    if (d->pixmapCache->findPixmap(key, &temp) && !temp.isNull()) {
-        pix = temp;
-        return true;
-    }
-
-    return false;
+    return d->findInCache(d->publicCacheKey(key), pix, lastModified, QString(), QString(), 1, true);
 }
 
 void Theme::insertIntoCache(const QString &key, const QPixmap &pix)
 {
-    if (d->useCache()) {
-        d->pixmapCache->insertPixmap(key, pix);
-    }
+    // written to disk by the writer of the image cache, as everything else,
+    // each key being its own id as nothing tells the callers apart
+    insertIntoCache(key, pix, key);
 }
 
 void Theme::insertIntoCache(const QString &key, const QPixmap &pix, const QString &id)
 {
-    if (d->useCache()) {
-        d->pixmapsToCache[id] = pix;
-        d->keysToCache[key] = id;
-        d->idsToCache[id] = key;
-
-        //always start timer in d->pixmapSaveTimer's thread
-        QMetaObject::invokeMethod(d->pixmapSaveTimer, "start", Qt::QueuedConnection);
-    }
+    d->insertIntoPublicCache(key, pix, id);
 }
 
 bool Theme::findInRectsCache(const QString &image, const QString &element, QRectF &rect) const
@@ -385,10 +279,62 @@ void Theme::releaseRectsCache(const QString &image)
 void Theme::setCacheLimit(int kbytes)
 {
     d->cacheSize = kbytes;
+    d->imageCache.setSharedCache(nullptr);
     delete d->pixmapCache;
     d->pixmapCache = nullptr;
 }
 
+void Theme::setMemoryCacheLimit(int kbytes)
+{
+    d->imageCache.setMemoryBudget(qint64(kbytes) * 1024);
+}
+
+QVariantMap Theme::cacheStatistics() const
+{
+    auto tierMap = [this](ThemeImageCache::Tier tier) {
+        const ThemeImageCache::TierStatistics statistics = d->imageCache.statistics(tier);
+        return QVariantMap{
+            {QStringLiteral("budget"), statistics.budget},
+            {QStringLiteral("used"), statistics.used},
+            {QStringLiteral("images"), statistics.images},
+            {QStringLiteral("hits"), statistics.hits},
+            {QStringLiteral("misses"), statistics.misses},
+            {QStringLiteral("insertions"), statistics.insertions},
+            {QStringLiteral("evictions"), statistics.evictions},
+        };
+    };
+
+    QVariantMap consumers;
+    const auto &consumerStatistics = d->imageCache.consumers();
+    for (auto it = consumerStatistics.constBegin(); it != consumerStatistics.constEnd(); ++it) {
+        QVariantMap elements;
+        const QHash<QString, qint64> elementBytes = d->imageCache.elementBytes(it.key());
+        for (auto elementIt = elementBytes.constBegin(); elementIt != elementBytes.constEnd(); ++elementIt) {
+            elements.insert(elementIt.key(), elementIt.value());
+        }
+
+        consumers.insert(it.key(), QVariantMap{
+            {QStringLiteral("bytes"), it->bytes},
+            {QStringLiteral("images"), it->images},
+            {QStringLiteral("hits"), it->hits},
+            {QStringLiteral("misses"), it->misses},
+            {QStringLiteral("elements"), elements},
+        });
+    }
+
+    QVariantMap shared = tierMap(ThemeImageCache::SharedTier);
+    const ThemeImageCache::TierStatistics sharedStatistics = d->imageCache.statistics(ThemeImageCache::SharedTier);
+    shared.insert(QStringLiteral("queued"), sharedStatistics.queued);
+    shared.insert(QStringLiteral("flushes"), sharedStatistics.flushes);
+    shared.insert(QStringLiteral("lastFlushTime"), sharedStatistics.lastFlushTime);
+
+    return QVariantMap{
+        {QStringLiteral("memory"), tierMap(ThemeImageCache::MemoryTier)},
+        {QStringLiteral("shared"), shared},
+        {QStringLiteral("consumers"), consumers},
+    };
+}
+
 KPluginInfo Theme::pluginInfo() const
 {
     return KPluginInfo(d->pluginMetaData);
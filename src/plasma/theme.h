@@ -11,6 +11,7 @@
 #include <QGuiApplication>
 #include <QFont>
 #include <QObject>
+#include <QVariant>
 
 #include <KPluginInfo>
 #include <KSharedConfig>
@@ -121,6 +122,12 @@ public:
     /**
      * Retrieves the default wallpaper associated with this theme.
      *
+     * When there is no image of the exact size, the one closest to it in aspect
+     * ratio and area is returned, preferring bigger images to smaller ones.
+     * If scaleWallpapers is enabled in the Theme group of plasmarc, a copy of
+     * an image bigger than needed is scaled down once and returned from the cache
+     * from then on (since 5.79).
+     *
      * @param size the target height and width of the wallpaper; if an invalid size
      *           is passed in, then a default size will be provided instead.
      * @return the full path to the wallpaper image
@@ -237,6 +244,10 @@ public:
      *
      * @param key the name to use in the cache for this pixmap
      * @param pix the pixmap data to store in the cache
+     *
+     * @note As before, the pixmaps stored here aren't found anymore once the
+     *       colors or the compositing change. Since KF 5.79 the rest of the
+     *       cache, the renderings of Svg and FrameSvg, stays valid then.
      **/
     void insertIntoCache(const QString &key, const QPixmap &pix);
 
@@ -256,6 +267,9 @@ public:
      *           This is needed to limit disk writes of the cache.
      *           If an image with the same id changes quickly,
      *           only the last size where insertIntoCache was called is actually stored on disk
+     *
+     * @note The pixmaps stored here aren't found anymore once the colors or
+     *       the compositing change, see insertIntoCache(const QString &, const QPixmap &)
      * @since 4.3
      **/
     void insertIntoCache(const QString &key, const QPixmap &pix, const QString &id);
@@ -270,6 +284,33 @@ public:
      **/
     void setCacheLimit(int kbytes);
 
+    /**
+     * Sets the maximum size (in kilobytes) of the images rendered with this
+     * theme that this process keeps in memory, in front of the disk cache.
+     * The least recently used images are dropped first; 0 disables it.
+     *
+     * @since 5.79
+     **/
+    void setMemoryCacheLimit(int kbytes);
+
+    /**
+     * Statistics about the caches of the images rendered with this theme,
+     * to help sizing them. The map has three entries:
+     * - "memory" and "shared", for the in-memory cache and the disk cache
+     *   shared between processes: their "budget" and "used" size in bytes,
+     *   the "images" they hold, their "hits", "misses", "insertions" and
+     *   "evictions". The number of images and the evictions of the disk
+     *   cache are not known. New images are written to the disk cache in the
+     *   background: "shared" also has the number of images "queued" for it,
+     *   the "flushes" of that queue and the "lastFlushTime" in milliseconds.
+     * - "consumers", by image path: the "bytes" and "images" its renderings
+     *   take in memory, how often they were looked up with "hits" and
+     *   "misses", and the bytes each element takes in memory in "elements"
+     *
+     * @since 5.79
+     **/
+    QVariantMap cacheStatistics() const;
+
 #if PLASMA_ENABLE_DEPRECATED_SINCE(5, 78)
     /**
      * Tries to load the rect of a sub element from a disk cache
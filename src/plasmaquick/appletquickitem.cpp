@@ -8,12 +8,13 @@
 #include "private/appletquickitem_p.h"
 #include "debug_p.h"
 
+#include <QDateTime>
 #include <QJsonArray>
 #include <QQmlExpression>
 #include <QQmlProperty>
 #include <QQmlContext>
 #include <QQuickWindow>
-#include <QRandomGenerator>
+#include <QTimer>
 
 #include <QDebug>
 
@@ -28,6 +29,8 @@
 #include <private/package_p.h>
 #include <qloggingcategory.h>
 
+#include <algorithm>
+
 namespace PlasmaQuick
 {
 
@@ -35,6 +38,123 @@ QHash<QObject *, AppletQuickItem *> AppletQuickItemPrivate::s_rootObjects = QHas
 
 AppletQuickItemPrivate::PreloadPolicy AppletQuickItemPrivate::s_preloadPolicy = AppletQuickItemPrivate::Uninitialized;
 
+// Process-wide queue of the popups waiting to be preloaded: instead of every
+// applet arming its own timer, popups are created one per slot in order of
+// weight, so the most used ones are ready first, and the queue backs off
+// whenever the user interacts with the shell
+class PreloadScheduler : public QObject
+{
+public:
+    enum Timings {
+        // delay between two preloads
+        SlotInterval = 250,
+        // pause after any user input
+        InteractionBackoff = 3000
+    };
+
+    static PreloadScheduler *self()
+    {
+        if (!s_self) {
+            s_self = new PreloadScheduler(QCoreApplication::instance());
+        }
+        return s_self;
+    }
+
+    // Drops the pending preload of an applet, if any, without creating
+    // the scheduler, which is also gone once the application quits
+    static void cancelIfScheduled(AppletQuickItemPrivate *d)
+    {
+        if (s_self) {
+            s_self->cancel(d);
+        }
+    }
+
+    void schedule(AppletQuickItem *item, AppletQuickItemPrivate *d, int weight)
+    {
+        cancel(d);
+
+        Job job{QPointer<AppletQuickItem>(item), d, weight};
+        auto it = std::upper_bound(m_jobs.begin(), m_jobs.end(), job, [](const Job &a, const Job &b) {
+            return a.weight > b.weight;
+        });
+        m_jobs.insert(it, job);
+
+        if (!m_timer.isActive()) {
+            m_timer.start(InteractionBackoff);
+        }
+    }
+
+    void cancel(AppletQuickItemPrivate *d)
+    {
+        auto it = std::remove_if(m_jobs.begin(), m_jobs.end(), [d](const Job &job) {
+            return job.d == d;
+        });
+        m_jobs.erase(it, m_jobs.end());
+
+        if (m_jobs.isEmpty()) {
+            m_timer.stop();
+        }
+    }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (!m_jobs.isEmpty()) {
+            switch (event->type()) {
+            case QEvent::MouseButtonPress:
+            case QEvent::KeyPress:
+            case QEvent::Wheel:
+            case QEvent::TouchBegin:
+                m_timer.start(InteractionBackoff);
+                break;
+            default:
+                break;
+            }
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    struct Job {
+        QPointer<AppletQuickItem> item;
+        AppletQuickItemPrivate *d;
+        int weight;
+    };
+
+    explicit PreloadScheduler(QObject *parent)
+        : QObject(parent)
+    {
+        m_timer.setSingleShot(true);
+        connect(&m_timer, &QTimer::timeout, this, &PreloadScheduler::runNext);
+        QCoreApplication::instance()->installEventFilter(this);
+    }
+
+    void runNext()
+    {
+        while (!m_jobs.isEmpty()) {
+            const Job job = m_jobs.takeFirst();
+            if (!job.item) {
+                continue;
+            }
+
+            qCDebug(LOG_PLASMAQUICK) << "Scheduled preload of" << job.d->applet->title() << "with a weight of" << job.weight;
+            job.d->preloadForExpansion();
+            break;
+        }
+
+        if (!m_jobs.isEmpty()) {
+            m_timer.start(SlotInterval);
+        }
+    }
+
+    static QPointer<PreloadScheduler> s_self;
+
+    QVector<Job> m_jobs;
+    QTimer m_timer;
+};
+
+QPointer<PreloadScheduler> PreloadScheduler::s_self;
+
 AppletQuickItemPrivate::AppletQuickItemPrivate(Plasma::Applet *a, AppletQuickItem *item)
     : q(item),
       switchWidth(-1),
@@ -499,6 +619,8 @@ AppletQuickItem::AppletQuickItem(Plasma::Applet *applet, QQuickItem *parent)
 
 AppletQuickItem::~AppletQuickItem()
 {
+    PreloadScheduler::cancelIfScheduled(d);
+
     //decrease weight
     if (d->s_preloadPolicy >= AppletQuickItemPrivate::Adaptive) {
         d->applet->config().writeEntry(QStringLiteral("PreloadWeight"), qMax(0, d->preloadWeight() - AppletQuickItemPrivate::PreloadWeightDecrement));
@@ -701,17 +823,9 @@ void AppletQuickItem::init()
 
                     //don't preload applets less then a certain weight
                     if (d->s_preloadPolicy >= AppletQuickItemPrivate::Aggressive || preloadWeight >= AppletQuickItemPrivate::DelayedPreloadWeight) {
-                        //spread the creation over a random delay to make it look
-                        //plasma started already, and load the popup in the background
-                        //without big noticeable freezes, the bigger the weight the smaller is likely
-                        //to be the delay, smaller minimum walue, smaller spread
-                        const int min = (100 - preloadWeight) * 20;
-                        const int max = (100 - preloadWeight) * 100;
-                        const int delay = QRandomGenerator::global()->bounded((max + 1) - min) + min;
-                        QTimer::singleShot(delay, this, [this, delay]() {
-                            qCDebug(LOG_PLASMAQUICK) << "Delayed preload of " << d->applet->title() << "after" << (qreal)delay/1000 << "seconds";
-                            d->preloadForExpansion();
-                        });
+                        //load the popup in the background, one applet at a time,
+                        //the most used ones first, without big noticeable freezes
+                        PreloadScheduler::self()->schedule(this, d, preloadWeight);
                     }
                 }
             });
@@ -846,6 +960,7 @@ void AppletQuickItem::setExpanded(bool expanded)
     }
 
     if (expanded) {
+        PreloadScheduler::cancelIfScheduled(d);
         d->preloadForExpansion();
         //increase on open, ignore containments
         if (d->s_preloadPolicy >= AppletQuickItemPrivate::Adaptive && !d->applet->isContainment()) {
@@ -8,8 +8,16 @@
 #include "dialogshadows_p.h"
 #include "debug_p.h"
 
+#include <QSet>
+#include <QStringBuilder>
+
 #include <KWindowShadow>
 
+#include "plasma/theme.h"
+
+// how many themes and device pixel ratios keep their tiles around
+static const int s_maxTileSets = 4;
+
 class DialogShadows::Private
 {
 public:
@@ -22,10 +30,20 @@ public:
     {
     }
 
+    // the tiles of a theme at a device pixel ratio, shared by all the windows,
+    // in the order top, topright, right, bottomright, bottom, bottomleft, left, topleft
+    struct TileSet {
+        QVector<KWindowShadowTile::Ptr> tiles;
+        // padding of a window with all the borders enabled
+        QMargins padding;
+    };
+
     void clearTiles();
     void setupTiles();
-    void initTile(const QString &element);
-    void updateShadow(QWindow *window, Plasma::FrameSvg::EnabledBorders);
+    const TileSet &currentTiles();
+    void updateShadow(QWindow *window, Plasma::FrameSvg::EnabledBorders enabledBorders, bool recreate);
+    void scheduleUpdate(QWindow *window);
+    void flushPendingWindows();
     void clearShadow(QWindow *window);
     void updateShadows();
     void windowDestroyed(QObject *deletedObject);
@@ -34,7 +52,11 @@ public:
 
     QHash<QWindow *, Plasma::FrameSvg::EnabledBorders> m_windows;
     QHash<QWindow *, KWindowShadow *> m_shadows;
-    QVector<KWindowShadowTile::Ptr> m_tiles;
+    QHash<QString, TileSet> m_tileSets;
+    QString m_currentTileSet;
+    // windows to update at the next flush
+    QSet<QWindow *> m_pendingWindows;
+    bool m_flushScheduled = false;
 };
 
 class DialogShadowsSingleton
@@ -74,7 +96,11 @@ void DialogShadows::addWindow(QWindow *window, Plasma::FrameSvg::EnabledBorders
     }
 
     d->m_windows[window] = enabledBorders;
-    d->updateShadow(window, enabledBorders);
+    // the window may have a new surface since the last time it was shown, and
+    // it is about to be mapped: the shadow has to be there right away, only
+    // the updates of windows already shown can wait for the next flush
+    d->m_pendingWindows.remove(window);
+    d->updateShadow(window, enabledBorders, true);
     connect(window, SIGNAL(destroyed(QObject*)),
             this, SLOT(windowDestroyed(QObject*)), Qt::UniqueConnection);
 }
@@ -86,6 +112,7 @@ void DialogShadows::removeWindow(QWindow *window)
     }
 
     d->m_windows.remove(window);
+    d->m_pendingWindows.remove(window);
     disconnect(window, nullptr, this, nullptr);
     d->clearShadow(window);
 
@@ -100,7 +127,8 @@ void DialogShadows::setEnabledBorders(QWindow *window, Plasma::FrameSvg::Enabled
         return;
     }
 
-    d->updateShadow(window, enabledBorders);
+    d->m_windows[window] = enabledBorders;
+    d->scheduleUpdate(window);
 }
 
 
@@ -109,6 +137,7 @@ void DialogShadows::Private::windowDestroyed(QObject *deletedObject)
     QWindow *window = static_cast<QWindow *>(deletedObject);
 
     m_windows.remove(window);
+    m_pendingWindows.remove(window);
     clearShadow(window);
 
     if (m_windows.isEmpty()) {
@@ -118,148 +147,155 @@ void DialogShadows::Private::windowDestroyed(QObject *deletedObject)
 
 void DialogShadows::Private::updateShadows()
 {
-    setupTiles();
-    QHash<QWindow *, Plasma::FrameSvg::EnabledBorders>::const_iterator i;
-    for (i = m_windows.constBegin(); i != m_windows.constEnd(); ++i) {
-        updateShadow(i.key(), i.value());
+    if (m_windows.isEmpty()) {
+        clearTiles();
+        return;
     }
-}
-
-void DialogShadows::Private::initTile(const QString &element)
-{
-    const QImage image = q->pixmap(element).toImage();
 
-    KWindowShadowTile::Ptr tile = KWindowShadowTile::Ptr::create();
-    tile->setImage(image);
-
-    m_tiles << tile;
+    setupTiles();
+    for (auto it = m_windows.constBegin(); it != m_windows.constEnd(); ++it) {
+        scheduleUpdate(it.key());
+    }
 }
 
 void DialogShadows::Private::setupTiles()
 {
-    clearTiles();
-
-    initTile(QStringLiteral("shadow-top"));
-    initTile(QStringLiteral("shadow-topright"));
-    initTile(QStringLiteral("shadow-right"));
-    initTile(QStringLiteral("shadow-bottomright"));
-    initTile(QStringLiteral("shadow-bottom"));
-    initTile(QStringLiteral("shadow-bottomleft"));
-    initTile(QStringLiteral("shadow-left"));
-    initTile(QStringLiteral("shadow-topleft"));
-}
-
-void DialogShadows::Private::clearTiles()
-{
-    m_tiles.clear();
-}
-
-void DialogShadows::Private::updateShadow(QWindow *window, Plasma::FrameSvg::EnabledBorders enabledBorders)
-{
-    if (m_tiles.isEmpty()) {
-        setupTiles();
+    static const QString elements[] = {
+        QStringLiteral("shadow-top"),
+        QStringLiteral("shadow-topright"),
+        QStringLiteral("shadow-right"),
+        QStringLiteral("shadow-bottomright"),
+        QStringLiteral("shadow-bottom"),
+        QStringLiteral("shadow-bottomleft"),
+        QStringLiteral("shadow-left"),
+        QStringLiteral("shadow-topleft"),
+    };
+
+    m_currentTileSet = q->theme()->themeName() % QLatin1Char('_') % QString::number(q->devicePixelRatio());
+    if (!m_tileSets.contains(m_currentTileSet) && m_tileSets.count() >= s_maxTileSets) {
+        m_tileSets.clear();
     }
 
-    KWindowShadow *&shadow = m_shadows[window];
+    TileSet &set = m_tileSets[m_currentTileSet];
+    set.tiles.resize(8);
 
-    if (!shadow) {
-        shadow = new KWindowShadow(q);
-    }
+    for (int i = 0; i < 8; ++i) {
+        // Svg::image() hands out the same image as long as the theme didn't change,
+        // and a tile is only made again when its image really is different
+        const QImage image = q->image(QSize(), elements[i]);
+        if (set.tiles.at(i) && set.tiles.at(i)->image() == image) {
+            continue;
+        }
 
-    if (shadow->isCreated()) {
-        shadow->destroy();
+        KWindowShadowTile::Ptr tile = KWindowShadowTile::Ptr::create();
+        tile->setImage(image);
+        set.tiles[i] = tile;
     }
 
-    if (enabledBorders & Plasma::FrameSvg::TopBorder) {
-        shadow->setTopTile(m_tiles.at(0));
-    } else {
-        shadow->setTopTile(nullptr);
-    }
+    const QSize topHint = q->elementSize(QStringLiteral("shadow-hint-top-margin"));
+    const QSize rightHint = q->elementSize(QStringLiteral("shadow-hint-right-margin"));
+    const QSize bottomHint = q->elementSize(QStringLiteral("shadow-hint-bottom-margin"));
+    const QSize leftHint = q->elementSize(QStringLiteral("shadow-hint-left-margin"));
 
-    if (enabledBorders & Plasma::FrameSvg::TopBorder &&
-        enabledBorders & Plasma::FrameSvg::RightBorder) {
-        shadow->setTopRightTile(m_tiles.at(1));
-    } else {
-        shadow->setTopRightTile(nullptr);
-    }
+    set.padding = QMargins(leftHint.isValid() ? leftHint.width() : set.tiles.at(6)->image().width(),
+                           topHint.isValid() ? topHint.height() : set.tiles.at(0)->image().height(),
+                           rightHint.isValid() ? rightHint.width() : set.tiles.at(2)->image().width(),
+                           bottomHint.isValid() ? bottomHint.height() : set.tiles.at(4)->image().height());
+}
 
-    if (enabledBorders & Plasma::FrameSvg::RightBorder) {
-        shadow->setRightTile(m_tiles.at(2));
-    } else {
-        shadow->setRightTile(nullptr);
+const DialogShadows::Private::TileSet &DialogShadows::Private::currentTiles()
+{
+    auto it = m_tileSets.constFind(m_currentTileSet);
+    if (m_currentTileSet.isEmpty() || it == m_tileSets.constEnd()) {
+        setupTiles();
+        it = m_tileSets.constFind(m_currentTileSet);
     }
 
-    if (enabledBorders & Plasma::FrameSvg::BottomBorder &&
-        enabledBorders & Plasma::FrameSvg::RightBorder) {
-        shadow->setBottomRightTile(m_tiles.at(3));
-    } else {
-        shadow->setBottomRightTile(nullptr);
-    }
+    return *it;
+}
 
-    if (enabledBorders & Plasma::FrameSvg::BottomBorder) {
-        shadow->setBottomTile(m_tiles.at(4));
-    } else {
-        shadow->setBottomTile(nullptr);
-    }
+void DialogShadows::Private::clearTiles()
+{
+    m_tileSets.clear();
+    m_currentTileSet.clear();
+}
 
-    if (enabledBorders & Plasma::FrameSvg::BottomBorder &&
-        enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        shadow->setBottomLeftTile(m_tiles.at(5));
-    } else {
-        shadow->setBottomLeftTile(nullptr);
-    }
+void DialogShadows::Private::scheduleUpdate(QWindow *window)
+{
+    m_pendingWindows.insert(window);
 
-    if (enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        shadow->setLeftTile(m_tiles.at(6));
-    } else {
-        shadow->setLeftTile(nullptr);
+    // all the changes of an event loop iteration end up in a single update per window
+    if (!m_flushScheduled) {
+        m_flushScheduled = true;
+        QMetaObject::invokeMethod(q, "flushPendingWindows", Qt::QueuedConnection);
     }
+}
 
-    if (enabledBorders & Plasma::FrameSvg::TopBorder &&
-        enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        shadow->setTopLeftTile(m_tiles.at(7));
-    } else {
-        shadow->setTopLeftTile(nullptr);
-    }
+void DialogShadows::Private::flushPendingWindows()
+{
+    m_flushScheduled = false;
 
-    QMargins padding;
+    QSet<QWindow *> pendingWindows;
+    pendingWindows.swap(m_pendingWindows);
 
-    if (enabledBorders & Plasma::FrameSvg::TopBorder) {
-        const QSize marginHint = q->elementSize(QStringLiteral("shadow-hint-top-margin"));
-        if (marginHint.isValid()) {
-            padding.setTop(marginHint.height());
-        } else {
-            padding.setTop(m_tiles[0]->image().height());
+    for (QWindow *window : qAsConst(pendingWindows)) {
+        const auto enabledBorders = m_windows.constFind(window);
+        if (enabledBorders != m_windows.constEnd()) {
+            updateShadow(window, *enabledBorders, false);
         }
     }
+}
 
-    if (enabledBorders & Plasma::FrameSvg::RightBorder) {
-        const QSize marginHint = q->elementSize(QStringLiteral("shadow-hint-right-margin"));
-        if (marginHint.isValid()) {
-            padding.setRight(marginHint.width());
-        } else {
-            padding.setRight(m_tiles[2]->image().width());
-        }
+void DialogShadows::Private::updateShadow(QWindow *window, Plasma::FrameSvg::EnabledBorders enabledBorders, bool recreate)
+{
+    const TileSet &set = currentTiles();
+
+    auto tile = [&set, enabledBorders](int index, Plasma::FrameSvg::EnabledBorders borders) {
+        return (enabledBorders & borders) == borders ? set.tiles.at(index) : KWindowShadowTile::Ptr();
+    };
+
+    const KWindowShadowTile::Ptr top = tile(0, Plasma::FrameSvg::TopBorder);
+    const KWindowShadowTile::Ptr topRight = tile(1, Plasma::FrameSvg::TopBorder | Plasma::FrameSvg::RightBorder);
+    const KWindowShadowTile::Ptr right = tile(2, Plasma::FrameSvg::RightBorder);
+    const KWindowShadowTile::Ptr bottomRight = tile(3, Plasma::FrameSvg::BottomBorder | Plasma::FrameSvg::RightBorder);
+    const KWindowShadowTile::Ptr bottom = tile(4, Plasma::FrameSvg::BottomBorder);
+    const KWindowShadowTile::Ptr bottomLeft = tile(5, Plasma::FrameSvg::BottomBorder | Plasma::FrameSvg::LeftBorder);
+    const KWindowShadowTile::Ptr left = tile(6, Plasma::FrameSvg::LeftBorder);
+    const KWindowShadowTile::Ptr topLeft = tile(7, Plasma::FrameSvg::TopBorder | Plasma::FrameSvg::LeftBorder);
+
+    const QMargins padding(left ? set.padding.left() : 0,
+                           top ? set.padding.top() : 0,
+                           right ? set.padding.right() : 0,
+                           bottom ? set.padding.bottom() : 0);
+
+    KWindowShadow *&shadow = m_shadows[window];
+
+    if (!shadow) {
+        shadow = new KWindowShadow(q);
     }
 
-    if (enabledBorders & Plasma::FrameSvg::BottomBorder) {
-        const QSize marginHint = q->elementSize(QStringLiteral("shadow-hint-bottom-margin"));
-        if (marginHint.isValid()) {
-            padding.setBottom(marginHint.height());
-        } else {
-            padding.setBottom(m_tiles[4]->image().height());
-        }
+    // the shadow is only sent again when it changed
+    if (!recreate && shadow->isCreated() && shadow->window() == window &&
+        shadow->topTile() == top && shadow->topRightTile() == topRight &&
+        shadow->rightTile() == right && shadow->bottomRightTile() == bottomRight &&
+        shadow->bottomTile() == bottom && shadow->bottomLeftTile() == bottomLeft &&
+        shadow->leftTile() == left && shadow->topLeftTile() == topLeft &&
+        shadow->padding() == padding) {
+        return;
     }
 
-    if (enabledBorders & Plasma::FrameSvg::LeftBorder) {
-        const QSize marginHint = q->elementSize(QStringLiteral("shadow-hint-left-margin"));
-        if (marginHint.isValid()) {
-            padding.setLeft(marginHint.width());
-        } else {
-            padding.setLeft(m_tiles[6]->image().width());
-        }
+    if (shadow->isCreated()) {
+        shadow->destroy();
     }
 
+    shadow->setTopTile(top);
+    shadow->setTopRightTile(topRight);
+    shadow->setRightTile(right);
+    shadow->setBottomRightTile(bottomRight);
+    shadow->setBottomTile(bottom);
+    shadow->setBottomLeftTile(bottomLeft);
+    shadow->setLeftTile(left);
+    shadow->setTopLeftTile(topLeft);
     shadow->setPadding(padding);
     shadow->setWindow(window);
 
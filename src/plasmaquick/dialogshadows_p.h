@@ -34,6 +34,7 @@ private:
     Private *const d;
 
     Q_PRIVATE_SLOT(d, void updateShadows())
+    Q_PRIVATE_SLOT(d, void flushPendingWindows())
     Q_PRIVATE_SLOT(d, void windowDestroyed(QObject *deletedObject))
 };
 
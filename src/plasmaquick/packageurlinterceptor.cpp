@@ -11,6 +11,9 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QFileSelector>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QStandardPaths>
 
 #include <Plasma/PluginLoader>
@@ -37,14 +40,59 @@ public:
         delete selector;
     }
 
+    QUrl resolve(const QUrl &path, QQmlAbstractUrlInterceptor::DataType type);
+
+    bool probe(const QString &fileName)
+    {
+        ++statistics.filesystemProbes;
+        return QFile::exists(fileName);
+    }
+
     PackageUrlInterceptor *q;
     KPackage::Package package;
     QStringList allowedPaths;
     QQmlEngine *engine;
     QFileSelector *selector;
     bool forcePlasmaStyle = false;
+
+    // intercept() gets called from the QML loader thread as well
+    QMutex mutex;
+    QHash<QPair<QUrl, int>, QUrl> resolvedUrls;
+    PackageUrlInterceptor::Statistics statistics;
 };
 
+QUrl PackageUrlInterceptorPrivate::resolve(const QUrl &path, QQmlAbstractUrlInterceptor::DataType type)
+{
+    const QString urlPath = path.path();
+    // We assume we never rewritten qml/qmldir files
+    if (urlPath.endsWith(QLatin1String("qml"))
+        || urlPath.endsWith(QLatin1String("/inline"))) {
+        return selector->select(path);
+    }
+    // TODO KF6: Kill this hack
+    const QLatin1String marker("/ui/");
+    QString plainPath = path.toString();
+    const int index = plainPath.indexOf(marker);
+    if (index != -1) {
+        const QString prefix = QString::fromUtf8(PackageUrlInterceptor::prefixForType(type, urlPath));
+        plainPath = plainPath.leftRef(index)
+                    + QLatin1Char('/') + prefix + QLatin1Char('/') + plainPath.midRef(index + marker.size());
+
+        const QUrl url = QUrl(plainPath);
+        const QString newPath = url.path();
+        //search it in a resource or as a file on disk
+        if (!(plainPath.contains(QLatin1String("qrc")) && probe(QLatin1Char(':') + newPath))
+            && !probe(newPath)) {
+            return selector->select(path);
+        }
+        qWarning() <<"Warning: all files used by qml by the plasmoid should be in ui/. The file in the path"
+                   << plainPath << "was expected at" << path;
+        // This deprecated code path doesn't support selectors
+        return url;
+    }
+    return selector->select(path);
+}
+
 
 PackageUrlInterceptor::PackageUrlInterceptor(QQmlEngine *engine, const KPackage::Package &p)
     : QQmlAbstractUrlInterceptor(),
@@ -83,42 +131,37 @@ void PackageUrlInterceptor::setForcePlasmaStyle(bool force)
     d->forcePlasmaStyle = force;
 }
 
+PackageUrlInterceptor::Statistics PackageUrlInterceptor::statistics() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->statistics;
+}
+
 QUrl PackageUrlInterceptor::intercept(const QUrl &path, QQmlAbstractUrlInterceptor::DataType type)
 {
     //qDebug() << "Intercepted URL:" << path << type;
 
-    const QString urlPath = path.path();
     // Don't intercept qmldir files, to prevent double interception
-    if (urlPath.endsWith(QLatin1String("qmldir"))) {
+    if (path.path().endsWith(QLatin1String("qmldir"))) {
         return path;
     }
-    // We assume we never rewritten qml/qmldir files
-    if (urlPath.endsWith(QLatin1String("qml"))
-        || urlPath.endsWith(QLatin1String("/inline"))) {
-        return d->selector->select(path);
-    }
-    const QString prefix = QString::fromUtf8(prefixForType(type, urlPath));
-    // TODO KF6: Kill this hack
-    const QLatin1String marker("/ui/");
-    QString plainPath = path.toString();
-    const int index = plainPath.indexOf(marker);
-    if (index != -1) {
-        plainPath = plainPath.leftRef(index)
-                    + QLatin1Char('/') + prefix + QLatin1Char('/') + plainPath.midRef(index + marker.size());
 
-        const QUrl url = QUrl(plainPath);
-        const QString newPath = url.path();
-        //search it in a resource or as a file on disk
-        if (!(plainPath.contains(QLatin1String("qrc")) && QFile::exists(QLatin1Char(':') + newPath))
-            && !QFile::exists(newPath)) {
-            return d->selector->select(path);
-        }
-        qWarning() <<"Warning: all files used by qml by the plasmoid should be in ui/. The file in the path"
-                   << plainPath << "was expected at" << path;
-        // This deprecated code path doesn't support selectors
-        return url;
+    QMutexLocker locker(&d->mutex);
+    ++d->statistics.intercepts;
+
+    // The same urls get resolved over and over while loading a package; the
+    // package and the selector are set once for the interceptor, so what an
+    // url resolves to only changes with the files on disk, like for QML itself
+    const QPair<QUrl, int> key(path, type);
+    auto it = d->resolvedUrls.constFind(key);
+    if (it != d->resolvedUrls.constEnd()) {
+        ++d->statistics.cacheHits;
+        return *it;
     }
-    return d->selector->select(path);
+
+    const QUrl resolved = d->resolve(path, type);
+    d->resolvedUrls.insert(key, resolved);
+    return resolved;
 }
 
 }
@@ -45,6 +45,17 @@ public:
     bool forcePlasmaStyle() const;
     void setForcePlasmaStyle(bool force);
 
+    /**
+     * Counters of the work done by intercept(), useful to profile the loading
+     * of big packages.
+     */
+    struct Statistics {
+        quint64 intercepts = 0;
+        quint64 cacheHits = 0;
+        quint64 filesystemProbes = 0;
+    };
+    Statistics statistics() const;
+
     QUrl intercept(const QUrl &path, QQmlAbstractUrlInterceptor::DataType type) override;
 
     static inline QByteArray prefixForType(QQmlAbstractUrlInterceptor::DataType type, const QString &fileName)
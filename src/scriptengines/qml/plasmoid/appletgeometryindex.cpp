@@ -0,0 +1,218 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "appletgeometryindex.h"
+
+#include <QQuickItem>
+
+#include <cmath>
+#include <limits>
+
+// side of a grid cell, in pixels: about the size of a small applet
+static const qreal s_cellSize = 128;
+// rects spanning more cells than this are kept out of the grid
+static const int s_maxCellsPerItem = 256;
+
+static inline int cellCoordinate(qreal value)
+{
+    return int(std::floor(value / s_cellSize));
+}
+
+static inline quint64 cellKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+template<typename Function>
+static void forEachCell(const QRectF &rect, Function function)
+{
+    const int left = cellCoordinate(rect.left());
+    const int right = cellCoordinate(rect.right());
+    const int top = cellCoordinate(rect.top());
+    const int bottom = cellCoordinate(rect.bottom());
+
+    for (int x = left; x <= right; ++x) {
+        for (int y = top; y <= bottom; ++y) {
+            function(cellKey(x, y));
+        }
+    }
+}
+
+AppletGeometryIndex::AppletGeometryIndex(QQuickItem *root, QObject *parent)
+    : QObject(parent),
+      m_root(root)
+{
+}
+
+AppletGeometryIndex::~AppletGeometryIndex()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        untrack(*it);
+    }
+}
+
+void AppletGeometryIndex::insert(QQuickItem *item)
+{
+    if (!item || m_entries.contains(item)) {
+        return;
+    }
+
+    Entry &entry = m_entries[item];
+    entry.order = m_nextOrder++;
+    track(item, entry);
+    m_dirty.insert(item);
+}
+
+void AppletGeometryIndex::remove(QQuickItem *item)
+{
+    auto it = m_entries.find(item);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    untrack(*it);
+    // the item may be half destroyed already, only its pointer is used from now on
+    m_dirty.remove(item);
+    removeFromCells(item, it->rect);
+    m_entries.erase(it);
+}
+
+QQuickItem *AppletGeometryIndex::itemAt(const QPointF &pos)
+{
+    if (!m_root) {
+        return nullptr;
+    }
+
+    flush();
+
+    QQuickItem *found = nullptr;
+    quint64 foundOrder = std::numeric_limits<quint64>::max();
+
+    auto consider = [this, &pos, &found, &foundOrder](QQuickItem *item) {
+        const Entry &entry = *m_entries.constFind(item);
+        if (entry.order >= foundOrder || !entry.rect.contains(pos) || !item->isVisible()) {
+            return;
+        }
+        // the item has the last word, it may not be rectangular
+        if (item->contains(item->mapFromItem(m_root, pos))) {
+            found = item;
+            foundOrder = entry.order;
+        }
+    };
+
+    auto cellIt = m_cells.constFind(cellKey(cellCoordinate(pos.x()), cellCoordinate(pos.y())));
+    if (cellIt != m_cells.constEnd()) {
+        for (QQuickItem *item : *cellIt) {
+            consider(item);
+        }
+    }
+    for (QQuickItem *item : qAsConst(m_oversized)) {
+        consider(item);
+    }
+
+    return found;
+}
+
+void AppletGeometryIndex::track(QQuickItem *item, Entry &entry)
+{
+    untrack(entry);
+
+    auto markDirty = [this, item]() {
+        m_dirty.insert(item);
+    };
+    // a new ancestor means new items to follow
+    auto retrack = [this, item]() {
+        auto it = m_entries.find(item);
+        if (it != m_entries.end()) {
+            track(item, *it);
+            m_dirty.insert(item);
+        }
+    };
+
+    entry.connections << connect(item, &QObject::destroyed, this, [this, item]() {
+        remove(item);
+    });
+    entry.connections << connect(item, &QQuickItem::widthChanged, this, markDirty);
+    entry.connections << connect(item, &QQuickItem::heightChanged, this, markDirty);
+
+    // the position in the root item changes when any ancestor moves
+    for (QQuickItem *ancestor = item; ancestor && ancestor != m_root; ancestor = ancestor->parentItem()) {
+        entry.connections << connect(ancestor, &QQuickItem::xChanged, this, markDirty);
+        entry.connections << connect(ancestor, &QQuickItem::yChanged, this, markDirty);
+        entry.connections << connect(ancestor, &QQuickItem::parentChanged, this, retrack);
+    }
+}
+
+void AppletGeometryIndex::untrack(Entry &entry)
+{
+    for (const auto &connection : qAsConst(entry.connections)) {
+        disconnect(connection);
+    }
+    entry.connections.clear();
+}
+
+void AppletGeometryIndex::flush()
+{
+    if (m_dirty.isEmpty()) {
+        return;
+    }
+
+    for (QQuickItem *item : qAsConst(m_dirty)) {
+        Entry &entry = m_entries[item];
+        removeFromCells(item, entry.rect);
+        entry.rect = item->mapRectToItem(m_root, QRectF(0, 0, item->width(), item->height()));
+        addToCells(item, entry.rect);
+    }
+    m_dirty.clear();
+}
+
+void AppletGeometryIndex::addToCells(QQuickItem *item, const QRectF &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    if (isOversized(rect)) {
+        m_oversized.insert(item);
+        return;
+    }
+
+    forEachCell(rect, [this, item](quint64 key) {
+        m_cells[key].append(item);
+    });
+}
+
+void AppletGeometryIndex::removeFromCells(QQuickItem *item, const QRectF &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    if (isOversized(rect)) {
+        m_oversized.remove(item);
+        return;
+    }
+
+    forEachCell(rect, [this, item](quint64 key) {
+        auto it = m_cells.find(key);
+        if (it == m_cells.end()) {
+            return;
+        }
+        it->removeOne(item);
+        if (it->isEmpty()) {
+            m_cells.erase(it);
+        }
+    });
+}
+
+bool AppletGeometryIndex::isOversized(const QRectF &rect) const
+{
+    const qint64 columns = qint64(cellCoordinate(rect.right())) - cellCoordinate(rect.left()) + 1;
+    const qint64 rows = qint64(cellCoordinate(rect.bottom())) - cellCoordinate(rect.top()) + 1;
+    return columns * rows > s_maxCellsPerItem;
+}
+
+#include "moc_appletgeometryindex.cpp"
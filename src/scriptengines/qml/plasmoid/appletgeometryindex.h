@@ -0,0 +1,66 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef APPLETGEOMETRYINDEX_H
+#define APPLETGEOMETRYINDEX_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+
+class QQuickItem;
+
+/**
+ * @class AppletGeometryIndex
+ *
+ * Grid of the areas covered by the applets of a containment, used for hit testing.
+ * The rect of an applet is updated lazily, the next time the index is queried
+ * after the applet or one of its ancestors moved or got reparented.
+ */
+class AppletGeometryIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AppletGeometryIndex(QQuickItem *root, QObject *parent = nullptr);
+    ~AppletGeometryIndex() override;
+
+    void insert(QQuickItem *item);
+    void remove(QQuickItem *item);
+
+    /**
+     * @return the visible item containing pos, in coordinates of the root item.
+     * When items overlap, the one inserted first wins
+     */
+    QQuickItem *itemAt(const QPointF &pos);
+
+private:
+    struct Entry {
+        quint64 order = 0;
+        QRectF rect;
+        QVector<QMetaObject::Connection> connections;
+    };
+
+    void track(QQuickItem *item, Entry &entry);
+    void untrack(Entry &entry);
+    void flush();
+    void addToCells(QQuickItem *item, const QRectF &rect);
+    void removeFromCells(QQuickItem *item, const QRectF &rect);
+    bool isOversized(const QRectF &rect) const;
+
+    QPointer<QQuickItem> m_root;
+    QHash<QQuickItem *, Entry> m_entries;
+    QSet<QQuickItem *> m_dirty;
+    QHash<quint64, QVector<QQuickItem *>> m_cells;
+    // items covering too many cells to be worth indexing
+    QSet<QQuickItem *> m_oversized;
+    quint64 m_nextOrder = 0;
+};
+
+#endif
@@ -7,7 +7,9 @@
 */
 
 #include "containmentinterface.h"
+#include "appletgeometryindex.h"
 #include "wallpaperinterface.h"
+#include "dropclassifier.h"
 #include "dropmenu.h"
 #include <kdeclarative/qmlobject.h>
 
@@ -25,7 +27,6 @@
 #include <QDebug>
 #include <KLocalizedString>
 #include <KUrlMimeData>
-#include <QMimeDatabase>
 #include <KNotification>
 
 #include <KIO/DropJob>
@@ -51,6 +52,7 @@ ContainmentInterface::ContainmentInterface(DeclarativeAppletScript *parent, cons
       m_wheelDelta(0)
 {
     m_containment = static_cast<Plasma::Containment *>(appletScript()->applet()->containment());
+    m_appletIndex = new AppletGeometryIndex(this, this);
 
     setAcceptedMouseButtons(Qt::AllButtons);
 
@@ -218,6 +220,11 @@ void ContainmentInterface::setAppletArgs(Plasma::Applet *applet, const QString &
     }
 }
 
+QObject *ContainmentInterface::appletAt(int x, int y)
+{
+    return m_appletIndex->itemAt(QPointF(x, y));
+}
+
 QObject *ContainmentInterface::containmentAt(int x, int y)
 {
     QObject *desktop = nullptr;
@@ -282,113 +289,100 @@ QPointF ContainmentInterface::mapToApplet(AppletInterface *applet, int x, int y)
     return pos - applet->mapToScene(QPointF(0, 0));
 }
 
-QPointF ContainmentInterface::adjustToAvailableScreenRegion(int x, int y, int w, int h) const
+// Snapshot of the area of the screen applets can be placed in, relative to
+// the containment: built once, it can place any number of applets
+class PlacementArea
 {
-    QRegion reg;
-    int screenId = screen();
-    if (screenId > -1 && m_containment->corona()) {
-        reg = m_containment->corona()->availableScreenRegion(screenId);
-    }
+public:
+    explicit PlacementArea(const ContainmentInterface *containment)
+        : m_corona(containment->containment() ? containment->containment()->corona() : nullptr),
+          m_screen(containment->screen()),
+          m_availableRect(containment->availableScreenRect())
+    {
+        if (m_screen > -1 && m_corona) {
+            const QRegion region = m_corona->cachedAvailableScreenRegion(m_screen);
+            if (!region.isEmpty()) {
+                m_screenOrigin = m_corona->screenGeometry(m_screen).topLeft();
+                m_bounds = region.boundingRect().translated(-m_screenOrigin);
+                m_useRegion = true;
+            }
+        }
 
-    if (!reg.isEmpty()) {
-        //make it relative
-        QRect geometry = m_containment->corona()->screenGeometry(screenId);
-        reg.translate(- geometry.topLeft());
-    } else {
-        reg = QRect(0, 0, width(), height());
+        if (!m_useRegion) {
+            m_bounds = QRect(0, 0, containment->width(), containment->height());
+        }
     }
 
-    const QRect rect(qBound(reg.boundingRect().left(), x, reg.boundingRect().right() + 1 - w),
-                     qBound(reg.boundingRect().top(), y, reg.boundingRect().bottom() + 1 - h), w, h);
-    const QRectF ar = availableScreenRect();
-    QRect tempRect(rect);
-
-    // in the case we are in the topleft quadrant
-    // * see if the passed rect is completely in the region, if yes, return
-    // * otherwise, try to move it horizontally to the screenrect x
-    // * if now fits, return
-    // * if fail, move vertically
-    // * as last resort, move horizontally and vertically
-
-    // top left corner
-    if (rect.center().x() <= ar.center().x() && rect.center().y() <= ar.center().y()) {
-        //QRegion::contains doesn't do what it would suggest, so do reg.intersected(rect) != rect instead
-        if (reg.intersected(rect) != rect) {
-            tempRect = QRect(qMax(rect.left(), (int)ar.left()), rect.top(), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
+    bool fits(const QRect &rect) const
+    {
+        // an empty rect is always contained, as QRegion would have it
+        if (rect.isEmpty()) {
+            return true;
+        }
+        if (m_useRegion) {
+            return m_corona->availableScreenRegionContains(m_screen, rect.translated(m_screenOrigin));
+        }
+        return m_bounds.contains(rect);
+    }
 
-            tempRect = QRect(rect.left(), qMax(rect.top(), (int)ar.top()), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
+    QPoint place(int x, int y, int w, int h) const
+    {
+        const QRect rect(qBound(m_bounds.left(), x, m_bounds.right() + 1 - w),
+                         qBound(m_bounds.top(), y, m_bounds.bottom() + 1 - h), w, h);
 
-            tempRect = QRect(qMax(rect.left(), (int)ar.left()), qMax(rect.top(), (int)ar.top()), w, h);
-            return tempRect.topLeft();
-        } else {
+        // see if the passed rect is completely in the region, if yes, return
+        if (fits(rect)) {
             return rect.topLeft();
         }
 
-    //bottom left corner
-    } else if (rect.center().x() <= ar.center().x() && rect.center().y() > ar.center().y()) {
-        if (reg.intersected(rect) != rect) {
-            tempRect = QRect(qMax(rect.left(), (int)ar.left()), rect.top(), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
-
-            tempRect = QRect(rect.left(), qMin(rect.top(), (int)(ar.bottom() + 1 - h)), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
-
-            tempRect = QRect(qMax(rect.left(), (int)ar.left()), qMin(rect.top(), (int)(ar.bottom() + 1 - h)), w, h);
+        // otherwise move it towards the nearest edges of the available screen rect:
+        // * try to move it horizontally, if now fits, return
+        // * if fail, move vertically
+        // * as last resort, move horizontally and vertically
+        const QRectF &ar = m_availableRect;
+        const int movedX = rect.center().x() <= ar.center().x() ? qMax(rect.left(), (int)ar.left())
+                                                                : qMin(rect.left(), (int)(ar.right() + 1 - w));
+        const int movedY = rect.center().y() <= ar.center().y() ? qMax(rect.top(), (int)ar.top())
+                                                                : qMin(rect.top(), (int)(ar.bottom() + 1 - h));
+
+        QRect tempRect(movedX, rect.top(), w, h);
+        if (fits(tempRect)) {
             return tempRect.topLeft();
-        } else {
-            return rect.topLeft();
         }
 
-    //top right corner
-    } else if (rect.center().x() > ar.center().x() && rect.center().y() <= ar.center().y()) {
-        if (reg.intersected(rect) != rect) {
-            tempRect = QRect(qMin(rect.left(), (int)(ar.right() + 1 - w)), rect.top(), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
-
-            tempRect = QRect(rect.left(), qMax(rect.top(), (int)ar.top()), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
-
-            tempRect = QRect(qMin(rect.left(), (int)(ar.right() + 1 - w)), qMax(rect.top(), (int)ar.top()), w, h);
+        tempRect = QRect(rect.left(), movedY, w, h);
+        if (fits(tempRect)) {
             return tempRect.topLeft();
-        } else {
-            return rect.topLeft();
         }
 
-    //bottom right corner
-    } else if (rect.center().x() > ar.center().x() && rect.center().y() > ar.center().y()) {
-        if (reg.intersected(rect) != rect) {
-            tempRect = QRect(qMin(rect.left(), (int)(ar.right() + 1 - w)), rect.top(), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
+        return QPoint(movedX, movedY);
+    }
 
-            tempRect = QRect(rect.left(), qMin(rect.top(), (int)(ar.bottom() + 1 - h)), w, h);
-            if (reg.intersected(tempRect) == tempRect) {
-                return tempRect.topLeft();
-            }
+private:
+    Plasma::Corona *m_corona;
+    int m_screen;
+    QRectF m_availableRect;
+    QPoint m_screenOrigin;
+    QRect m_bounds;
+    bool m_useRegion = false;
+};
 
-            tempRect = QRect(qMin(rect.left(), (int)(ar.right() + 1 - w)), qMin(rect.top(), (int)(ar.bottom() + 1 - h)), w, h);
-            return tempRect.topLeft();
-        } else {
-            return rect.topLeft();
-        }
-    }
+QPointF ContainmentInterface::adjustToAvailableScreenRegion(int x, int y, int w, int h) const
+{
+    return PlacementArea(this).place(x, y, w, h);
+}
+
+QVariantList ContainmentInterface::adjustToAvailableScreenRegion(const QVariantList &rects) const
+{
+    const PlacementArea area(this);
 
-    return rect.topLeft();
+    QVariantList positions;
+    positions.reserve(rects.count());
+    for (const QVariant &rect : rects) {
+        const QRect r = rect.toRect();
+        positions << QVariant::fromValue(QPointF(area.place(r.x(), r.y(), r.width(), r.height())));
+    }
+    return positions;
 }
 
 QAction *ContainmentInterface::globalAction(QString name) const
@@ -458,23 +452,22 @@ void ContainmentInterface::processMimeData(QMimeData *mimeData, int x, int y, KI
         const QList<QUrl> urls = KUrlMimeData::urlsFromMimeData(mimeData);
         m_dropMenu->setUrls(urls);
 
-        if (!urls.at(0).isLocalFile()) {
-            QApplication::setOverrideCursor(Qt::WaitCursor);
-        }
+        // Whether the urls are all of the same type is found out in a worker
+        // thread, while KIO looks up the type of the first one
+        DropClassifier *classifier = new DropClassifier(urls, m_dropMenu);
+        connect(classifier, &DropClassifier::progress, m_dropMenu.data(), &DropMenu::setProgress);
+        connect(classifier, &DropClassifier::finished, m_dropMenu.data(), &DropMenu::setMultipleMimetypes);
 
-        QMimeDatabase db;
-        QMimeType firstMimetype = db.mimeTypeForUrl(urls.at(0));
-        for (const QUrl &url : urls) {
-            if (firstMimetype != db.mimeTypeForUrl(url)) {
-                m_dropMenu->setMultipleMimetypes(true);
-                break;
-            }
+        // slow drops get their menu right away, it is filled once everything is known
+        if (!urls.at(0).isLocalFile() || urls.count() > DropClassifier::batchSize()) {
+            m_dropMenu->showPending();
         }
+        classifier->start();
 
         // It may be a directory or a file, let's stat
         KIO::JobFlags flags = KIO::HideProgressInfo;
         KIO::MimetypeJob *job = KIO::mimetype(m_dropMenu->urls().at(0), flags);
-        job->setParent(m_dropMenu.data());
+        m_dropMenu->setMimeTypeJob(job);
 
         QObject::connect(job, &KJob::result, this, &ContainmentInterface::dropJobResult);
         QObject::connect(job, &KIO::MimetypeJob::mimeTypeFound,
@@ -545,10 +538,9 @@ void ContainmentInterface::clearDataForMimeJob(KIO::Job *job)
     QObject::disconnect(job, nullptr, this, nullptr);
     job->kill();
 
-    m_dropMenu->show();
-
-    if (!m_dropMenu->urls().at(0).isLocalFile()) {
-        QApplication::restoreOverrideCursor();
+    // the menu may have been dismissed meanwhile
+    if (m_dropMenu) {
+        m_dropMenu->show();
     }
 }
 
@@ -571,10 +563,36 @@ void ContainmentInterface::mimeTypeRetrieved(KIO::Job *job, const QString &mimet
         return;
     }
 
-    QList<KPluginMetaData> appletList = Plasma::PluginLoader::self()->listAppletMetaDataForUrl(tjob->url());
+    // the job isn't needed anymore once it found the type of the first url
+    const QUrl url = tjob->url();
+    QObject::disconnect(job, nullptr, this, nullptr);
+    job->kill();
+
+    if (!m_dropMenu) {
+        return;
+    }
+
+    DropClassifier *classifier = m_dropMenu->findChild<DropClassifier *>(QString(), Qt::FindDirectChildrenOnly);
+    if (classifier && !classifier->isFinished()) {
+        connect(classifier, &DropClassifier::finished, this, [this, url, mimetype]() {
+            populateDropMenu(url, mimetype);
+        });
+        return;
+    }
+
+    populateDropMenu(url, mimetype);
+}
+
+void ContainmentInterface::populateDropMenu(const QUrl &url, const QString &mimetype)
+{
+    if (!m_dropMenu) {
+        return;
+    }
+
+    QList<KPluginMetaData> appletList = Plasma::PluginLoader::self()->listAppletMetaDataForUrl(url);
     if (mimetype.isEmpty() && appletList.isEmpty()) {
-        clearDataForMimeJob(job);
-        qDebug() << "No applets found matching the url (" << tjob->url() << ") or the mimetype (" << mimetype << ")";
+        m_dropMenu->show();
+        qDebug() << "No applets found matching the url (" << url << ") or the mimetype (" << mimetype << ")";
         return;
     } else {
 
@@ -609,7 +627,7 @@ void ContainmentInterface::mimeTypeRetrieved(KIO::Job *job, const QString &mimet
                 installPlasmaPackageAction = new QAction(QIcon::fromTheme(QStringLiteral("application-x-plasma")), i18n("Install"), m_dropMenu);
                 m_dropMenu->addAction(installPlasmaPackageAction);
 
-                const QString &packagePath = tjob->url().toLocalFile();
+                const QString &packagePath = url.toLocalFile();
                 connect(installPlasmaPackageAction, &QAction::triggered, this, [this, packagePath]() {
                     using namespace KPackage;
                     PackageStructure *structure = PackageLoader::self()->loadPackageStructure(QStringLiteral("Plasma/Applet"));
@@ -659,7 +677,6 @@ void ContainmentInterface::mimeTypeRetrieved(KIO::Job *job, const QString &mimet
                 }
                 m_dropMenu->addAction(action);
                 action->setData(info.pluginId());
-                const QUrl url = tjob->url();
                 connect(action, &QAction::triggered, this, [this, action, mimetype, url]() {
                     Plasma::Applet *applet = createApplet(action->data().toString(), QVariantList(), QRect(m_dropMenu->dropPoint(), QSize(-1,-1)));
                     setAppletArgs(applet, mimetype, url.toString());
@@ -669,7 +686,6 @@ void ContainmentInterface::mimeTypeRetrieved(KIO::Job *job, const QString &mimet
                 QAction *action = new QAction(i18nc("Add icon widget", "Add Icon"), m_dropMenu);
                 m_dropMenu->addAction(action);
                 action->setData(QStringLiteral("org.kde.plasma.icon"));
-                const QUrl url = tjob->url();
                 connect(action, &QAction::triggered, this, [this, action, mimetype, url](){
                     Plasma::Applet *applet = createApplet(action->data().toString(), QVariantList(), QRect(m_dropMenu->dropPoint(), QSize(-1,-1)));
                     setAppletArgs(applet, mimetype, url.toString());
@@ -695,7 +711,6 @@ void ContainmentInterface::mimeTypeRetrieved(KIO::Job *job, const QString &mimet
                     }
                     m_dropMenu->addAction(action);
                     actionsToWallpapers.insert(action, info.pluginId());
-                    const QUrl url = tjob->url();
                     connect(action, &QAction::triggered, this, [this, url]() {
                         //set wallpapery stuff
                         if (m_wallpaperInterface && url.isValid()) {
@@ -708,7 +723,7 @@ void ContainmentInterface::mimeTypeRetrieved(KIO::Job *job, const QString &mimet
             //case in which we created the menu ourselves, just the "fetching type entry, directly create the icon applet
             if (!m_dropMenu->isDropjobMenu()) {
                 Plasma::Applet *applet = createApplet(QStringLiteral("org.kde.plasma.icon"), QVariantList(), QRect(m_dropMenu->dropPoint(), QSize(-1,-1)));
-                setAppletArgs(applet, mimetype, tjob->url().toString());
+                setAppletArgs(applet, mimetype, url.toString());
             } else {
                 QAction *action;
                 QAction *sep = new QAction(i18n("Widgets"), m_dropMenu);
@@ -718,14 +733,13 @@ void ContainmentInterface::mimeTypeRetrieved(KIO::Job *job, const QString &mimet
                 action = new QAction(i18nc("Add icon widget", "Add Icon"), m_dropMenu);
                 m_dropMenu->addAction(action);
 
-                const QUrl url = tjob->url();
                 connect(action, &QAction::triggered, this, [this, mimetype, url](){
                     Plasma::Applet *applet = createApplet(QStringLiteral("org.kde.plasma.icon"), QVariantList(), QRect(m_dropMenu->dropPoint(), QSize(-1,-1)));
                     setAppletArgs(applet, mimetype, url.toString());
                 });
             }
         }
-        clearDataForMimeJob(tjob);
+        m_dropMenu->show();
     }
 }
 
@@ -753,6 +767,7 @@ void ContainmentInterface::appletAddedForward(Plasma::Applet *applet)
     }
 
     m_appletInterfaces << appletGraphicObject;
+    m_appletIndex->insert(appletGraphicObject);
     connect(appletGraphicObject, &QObject::destroyed, this,
             [this](QObject *obj) {
                 m_appletInterfaces.removeAll(obj);
@@ -766,6 +781,7 @@ void ContainmentInterface::appletRemovedForward(Plasma::Applet *applet)
     AppletInterface *appletGraphicObject = applet->property("_plasma_graphicObject").value<AppletInterface *>();
     if (appletGraphicObject) {
         m_appletInterfaces.removeAll(appletGraphicObject);
+        m_appletIndex->remove(appletGraphicObject);
         appletGraphicObject->m_positionBeforeRemoval = appletGraphicObject->mapToItem(this, QPointF());
     }
     Q_EMIT appletRemoved(appletGraphicObject);
@@ -910,17 +926,9 @@ void ContainmentInterface::mousePressEvent(QMouseEvent *event)
         return;
     }
 
-    //FIXME: very inefficient appletAt() implementation
     Plasma::Applet *applet = nullptr;
-    for (QObject *appletObject : qAsConst(m_appletInterfaces)) {
-        if (AppletInterface *ai = qobject_cast<AppletInterface *>(appletObject)) {
-            if (ai->isVisible() && ai->contains(ai->mapFromItem(this, event->localPos()))) {
-                applet = ai->applet();
-                break;
-            } else {
-                ai = nullptr;
-            }
-        }
+    if (AppletInterface *ai = qobject_cast<AppletInterface *>(m_appletIndex->itemAt(event->localPos()))) {
+        applet = ai->applet();
     }
     //qDebug() << "Invoking menu for applet" << applet;
 
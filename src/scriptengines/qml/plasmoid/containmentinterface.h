@@ -14,6 +14,7 @@
 
 #include "appletinterface.h"
 
+class AppletGeometryIndex;
 class WallpaperInterface;
 class DropMenu;
 
@@ -114,6 +115,13 @@ public:
      */
     Q_INVOKABLE void processMimeData(QObject *data, int x, int y, KIO::DropJob *dropJob = nullptr);
 
+    /**
+     * Search for an applet of this containment at those coordinates.
+     * the coordinates are passed as local coordinates of *this* containment
+     * @return the graphic object of the applet, or null if there is none
+     */
+    Q_INVOKABLE QObject *appletAt(int x, int y);
+
     /**
      * Search for a containment at those coordinates.
      * the coordinates are passed as local coordinates of *this* containment
@@ -143,6 +151,13 @@ public:
      */
     Q_INVOKABLE QPointF adjustToAvailableScreenRegion(int x, int y, int w, int h) const;
 
+    /**
+     * Same as above for a list of geometries at once, like when arranging
+     * all the applets of a desktop: the available region is looked up only once.
+     * @return the topLeft points of the rectangles, in the same order
+     */
+    Q_INVOKABLE QVariantList adjustToAvailableScreenRegion(const QVariantList &rects) const;
+
     /**
      * @returns a named action from global Corona's actions
      */
@@ -206,10 +221,12 @@ private Q_SLOTS:
 
 private:
     void clearDataForMimeJob(KIO::Job *job);
+    void populateDropMenu(const QUrl &url, const QString &mimetype);
     void setAppletArgs(Plasma::Applet *applet, const QString &mimetype, const QString &data);
 
     WallpaperInterface *m_wallpaperInterface;
     QList<QObject *> m_appletInterfaces;
+    AppletGeometryIndex *m_appletIndex;
     KActivities::Info *m_activityInfo;
     QPointer<Plasma::Containment> m_containment;
     QPointer<QMenu> m_contextMenu;
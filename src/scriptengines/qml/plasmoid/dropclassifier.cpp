@@ -0,0 +1,122 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "dropclassifier.h"
+
+#include <QCoreApplication>
+#include <QMimeDatabase>
+#include <QPointer>
+#include <QRunnable>
+#include <QThreadPool>
+
+static const int s_batchSize = 32;
+
+class DropClassifierRunnable : public QRunnable
+{
+public:
+    DropClassifierRunnable(const QList<QUrl> &urls, const std::shared_ptr<QAtomicInt> &canceled, DropClassifier *classifier)
+        : m_urls(urls),
+          m_canceled(canceled),
+          m_classifier(classifier)
+    {
+    }
+
+    void run() override
+    {
+        // QMimeDatabase is thread safe, and only looks at the name of remote urls
+        QMimeDatabase db;
+        const QString firstMimetype = db.mimeTypeForUrl(m_urls.at(0)).name();
+
+        int classified = 1;
+        bool mixed = false;
+        while (classified < m_urls.count() && !mixed) {
+            if (m_canceled->loadAcquire()) {
+                return;
+            }
+
+            const int batchEnd = qMin(classified + s_batchSize, m_urls.count());
+            for (; classified < batchEnd; ++classified) {
+                if (db.mimeTypeForUrl(m_urls.at(classified)).name() != firstMimetype) {
+                    mixed = true;
+                    ++classified;
+                    break;
+                }
+            }
+
+            const bool done = mixed || classified == m_urls.count();
+            QPointer<DropClassifier> classifier = m_classifier;
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [classifier, classified, mixed, done]() {
+                if (classifier) {
+                    classifier->batchClassified(classified, mixed, done);
+                }
+            }, Qt::QueuedConnection);
+        }
+    }
+
+private:
+    const QList<QUrl> m_urls;
+    const std::shared_ptr<QAtomicInt> m_canceled;
+    // only dereferenced in the gui thread
+    const QPointer<DropClassifier> m_classifier;
+};
+
+DropClassifier::DropClassifier(const QList<QUrl> &urls, QObject *parent)
+    : QObject(parent),
+      m_urls(urls),
+      m_canceled(std::make_shared<QAtomicInt>(0))
+{
+}
+
+DropClassifier::~DropClassifier()
+{
+    m_canceled->storeRelease(1);
+}
+
+int DropClassifier::batchSize()
+{
+    return s_batchSize;
+}
+
+void DropClassifier::start()
+{
+    if (m_started) {
+        return;
+    }
+    m_started = true;
+
+    // a single url is never of mixed types
+    if (m_urls.count() < 2) {
+        batchClassified(m_urls.count(), false, true);
+        return;
+    }
+
+    QThreadPool::globalInstance()->start(new DropClassifierRunnable(m_urls, m_canceled, this));
+}
+
+bool DropClassifier::isFinished() const
+{
+    return m_finished;
+}
+
+bool DropClassifier::isMixed() const
+{
+    return m_mixed;
+}
+
+void DropClassifier::batchClassified(int classified, bool mixed, bool done)
+{
+    m_classified = classified;
+    m_mixed = mixed;
+
+    if (done) {
+        m_finished = true;
+        Q_EMIT finished(m_mixed);
+    } else {
+        Q_EMIT progress(m_classified, m_urls.count());
+    }
+}
+
+#include "moc_dropclassifier.cpp"
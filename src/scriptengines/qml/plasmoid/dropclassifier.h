@@ -0,0 +1,61 @@
+/*
+    SPDX-FileCopyrightText: 2026 KDE e.V. <kde-ev-board@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef DROPCLASSIFIER_H
+#define DROPCLASSIFIER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QObject>
+#include <QUrl>
+
+#include <memory>
+
+/**
+ * @class DropClassifier
+ *
+ * Finds out in a worker thread whether the dropped urls are all of the same
+ * mimetype, as the drop menu only offers widgets and wallpapers for those.
+ * The urls are looked up in batches, every batch is reported back as it is
+ * done and the lookup stops at the first url of a different type.
+ */
+class DropClassifier : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DropClassifier(const QList<QUrl> &urls, QObject *parent = nullptr);
+    ~DropClassifier() override;
+
+    /**
+     * Number of urls looked up between two reports
+     */
+    static int batchSize();
+
+    void start();
+
+    bool isFinished() const;
+    bool isMixed() const;
+
+Q_SIGNALS:
+    void progress(int classified, int total);
+    void finished(bool mixed);
+
+private:
+    void batchClassified(int classified, bool mixed, bool done);
+
+    QList<QUrl> m_urls;
+    // shared with the worker, which gives up as soon as nobody waits for it anymore
+    std::shared_ptr<QAtomicInt> m_canceled;
+    int m_classified = 0;
+    bool m_started = false;
+    bool m_finished = false;
+    bool m_mixed = false;
+
+    friend class DropClassifierRunnable;
+};
+
+#endif
@@ -17,6 +17,7 @@
 #include <QList>
 
 #include <KIO/DropJob>
+#include <KIO/Job>
 #include <KLocalizedString>
 
 DropMenu::DropMenu(KIO::DropJob *dropJob, const QPoint &dropPoint, ContainmentInterface *parent)
@@ -26,10 +27,19 @@ DropMenu::DropMenu(KIO::DropJob *dropJob, const QPoint &dropPoint, ContainmentIn
 {
     if (!dropJob) {
         m_menu = new QMenu(i18n("Content dropped"));
-        if (m_menu->winId()) {
+        if (parent && m_menu->winId()) {
             m_menu->windowHandle()->setTransientParent(parent->window());
         }
-        connect(m_menu, &QMenu::aboutToHide, this, &QObject::deleteLater);
+        connect(m_menu, &QMenu::aboutToHide, this, [this]() {
+            // dismissed while the content is still being looked up
+            if (m_mimeTypeJob) {
+                if (parent()) {
+                    QObject::disconnect(m_mimeTypeJob, nullptr, parent(), nullptr);
+                }
+                m_mimeTypeJob->kill();
+            }
+            deleteLater();
+        });
     } else {
         connect(m_dropJob, &QObject::destroyed, this, &QObject::deleteLater);
     }
@@ -63,8 +73,52 @@ void DropMenu::show()
         m_dropJob->setApplicationActions(m_dropActions);
         m_dropJob->showMenu(m_dropPoint);
     } else if (m_menu) {
+        delete m_pendingAction;
+        m_pendingAction = nullptr;
+
+        if (m_dropActions.isEmpty()) {
+            // nothing to offer, hiding the menu deletes us
+            if (m_menu->isVisible()) {
+                m_menu->hide();
+            } else {
+                deleteLater();
+            }
+            return;
+        }
+
         m_menu->addActions(m_dropActions);
-        m_menu->popup(m_dropPoint);
+        if (!m_menu->isVisible()) {
+            m_menu->popup(m_dropPoint);
+        }
+    }
+}
+
+void DropMenu::showPending()
+{
+    if (!m_menu || m_pendingAction) {
+        return;
+    }
+
+    m_pendingAction = new QAction(i18n("Looking up the dropped content…"), this);
+    m_pendingAction->setEnabled(false);
+    m_menu->addAction(m_pendingAction);
+    m_menu->popup(m_dropPoint);
+}
+
+void DropMenu::setMimeTypeJob(KIO::Job *job)
+{
+    m_mimeTypeJob = job;
+    job->setParent(this);
+    // done or killed already, there's nothing left to stop
+    connect(job, &KJob::finished, this, [this]() {
+        m_mimeTypeJob = nullptr;
+    });
+}
+
+void DropMenu::setProgress(int classified, int total)
+{
+    if (m_pendingAction) {
+        m_pendingAction->setText(i18n("Looking up the dropped content (%1 of %2)…", classified, total));
     }
 }
 
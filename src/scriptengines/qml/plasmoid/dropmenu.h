@@ -10,6 +10,7 @@
 
 #include <QObject>
 #include <QPoint>
+#include <QPointer>
 
 class QJSValue;
 class QMenu;
@@ -18,6 +19,7 @@ class QAction;
 namespace KIO
 {
 class DropJob;
+class Job;
 }
 
 class ContainmentInterface;
@@ -40,10 +42,26 @@ public:
     bool isMultipleMimetypes() const;
     void show();
 
+    /**
+     * Pops up the menu right away with a placeholder entry, for drops whose
+     * actions take a while to be known. Does nothing for the menu of a DropJob,
+     * which can't be changed once shown
+     */
+    void showPending();
+    void setProgress(int classified, int total);
+
+    /**
+     * Takes over the job looking up the type of the dropped content. It gets
+     * killed when the menu is dismissed, its results have nowhere to go then
+     */
+    void setMimeTypeJob(KIO::Job *job);
+
 private:
     QPoint m_dropPoint;
     QMenu *m_menu = nullptr;
     KIO::DropJob *m_dropJob = nullptr;
+    QPointer<KIO::Job> m_mimeTypeJob;
+    QAction *m_pendingAction = nullptr;
     QList<QAction *> m_dropActions = QList<QAction *>();
     QList<QUrl> m_urls = QList<QUrl>();
     bool m_multipleMimetypes = false;